@@ -0,0 +1,325 @@
+#ifndef DS2025_BENCHMARK_H
+#define DS2025_BENCHMARK_H
+
+// 微基准测试框架（exp1、exp2、exp4 共用）：
+// 预热 + 多次采样，报告中位数 / p95 / p99；计时可选 steady_clock 或 CPU 周期计数器；
+// 输入分布可选顺序、逆序、随机、少量重复值、风琴管，支持规模扫描；
+// 结果可打印为表格，也可写成 CSV / JSON 以便在不同构建之间对比回归。
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define DS2025_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define DS2025_HAS_RDTSC 1
+#endif
+
+enum InputDistribution { DIST_SORTED, DIST_REVERSED, DIST_RANDOM, DIST_FEW_UNIQUE, DIST_ORGAN_PIPE };
+
+inline const char* distributionName(InputDistribution d) {
+    switch (d) {
+        case DIST_SORTED: return "sorted";
+        case DIST_REVERSED: return "reversed";
+        case DIST_RANDOM: return "random";
+        case DIST_FEW_UNIQUE: return "few-unique";
+        case DIST_ORGAN_PIPE: return "organ-pipe";
+    }
+    return "unknown";
+}
+
+inline std::vector<InputDistribution> allDistributions() {
+    InputDistribution all[] = {DIST_SORTED, DIST_REVERSED, DIST_RANDOM, DIST_FEW_UNIQUE, DIST_ORGAN_PIPE};
+    return std::vector<InputDistribution>(all, all + 5);
+}
+
+// 由已排好序的样本生成指定分布的输入
+template <class T>
+std::vector<T> arrangeInput(const std::vector<T>& sorted, InputDistribution d, unsigned seed) {
+    std::vector<T> out;
+    size_t n = sorted.size();
+    std::mt19937 gen(seed);
+    switch (d) {
+        case DIST_SORTED:
+            out = sorted;
+            break;
+        case DIST_REVERSED:
+            out.assign(sorted.rbegin(), sorted.rend());
+            break;
+        case DIST_RANDOM:
+            out = sorted;
+            std::shuffle(out.begin(), out.end(), gen);
+            break;
+        case DIST_FEW_UNIQUE: {
+            // 从样本中均匀取 16 个值，随机重复填满
+            const size_t distinct = 16;
+            out.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                out.push_back(sorted[(gen() % distinct) * n / distinct]);
+            }
+            break;
+        }
+        case DIST_ORGAN_PIPE:
+            // 偶数位升序在前、奇数位降序在后：先升后降
+            out.reserve(n);
+            for (size_t i = 0; i < n; i += 2) out.push_back(sorted[i]);
+            for (size_t i = (n % 2 == 0 ? n - 1 : n - 2); i < n; i -= 2) out.push_back(sorted[i]);
+            break;
+    }
+    return out;
+}
+
+// 规模扫描：from, from*factor, ... 不超过 to
+inline std::vector<size_t> geometricSizes(size_t from, size_t to, size_t factor) {
+    std::vector<size_t> sizes;
+    for (size_t n = from; n <= to && factor > 1; n *= factor) sizes.push_back(n);
+    return sizes;
+}
+
+// 让编译器认为 value 被读取过，计时代码算出的结果不会被当作无用计算删掉；本身不产生指令
+template <class T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile char* p = reinterpret_cast<const volatile char*>(&value);
+    (void)*p;
+    _ReadWriteBarrier();
+#endif
+}
+
+enum BenchClock { STEADY_CLOCK, CYCLE_COUNTER };
+
+struct BenchConfig {
+    int warmup;       // 预热次数（不记录）
+    int samples;      // 采样次数；最近秩法下不少于 20 次 p95 才不等于最大值，不少于 100 次 p99 才不等于最大值
+    BenchClock clock; // 计时方式；没有周期计数器时退回 steady_clock
+    unsigned seed;    // 输入分布的随机种子
+    BenchConfig() : warmup(1), samples(7), clock(STEADY_CLOCK), seed(12345) {}
+};
+
+struct BenchResult {
+    std::string name;
+    std::string dataset;         // 数据集标签，可为空
+    std::string distribution;
+    size_t n;
+    std::string unit;            // "ms" 或 "cycles"
+    std::vector<double> samples; // 升序
+    double min, median, p95, p99, mean;
+};
+
+// 最近秩法求分位数，samples 需已升序
+inline double percentile(const std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t rank = size_t(p * samples.size() + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > samples.size()) rank = samples.size();
+    return samples[rank - 1];
+}
+
+inline bool benchUsesCycles(const BenchConfig& cfg) {
+#ifdef DS2025_HAS_RDTSC
+    return cfg.clock == CYCLE_COUNTER;
+#else
+    (void)cfg;
+    return false;
+#endif
+}
+
+inline double benchNow(bool cycles) {
+#ifdef DS2025_HAS_RDTSC
+    if (cycles) return double(__rdtsc());
+#endif
+    (void)cycles;
+    return std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 每次（含预热）先调用 setup()（不计时），再对 run() 计时
+template <class Setup, class Run>
+BenchResult runBenchmark(const std::string& name, const std::string& distribution, size_t n,
+                         const BenchConfig& cfg, Setup setup, Run run) {
+    bool cycles = benchUsesCycles(cfg);
+    for (int i = 0; i < cfg.warmup; ++i) {
+        setup();
+        run();
+    }
+
+    BenchResult r;
+    r.name = name;
+    r.distribution = distribution;
+    r.n = n;
+    r.unit = cycles ? "cycles" : "ms";
+    for (int i = 0; i < std::max(1, cfg.samples); ++i) {
+        setup();
+        double start = benchNow(cycles);
+        run();
+        r.samples.push_back(benchNow(cycles) - start);
+    }
+    std::sort(r.samples.begin(), r.samples.end());
+    double sum = 0;
+    for (double s : r.samples) sum += s;
+    r.min = r.samples.front();
+    r.median = percentile(r.samples, 0.5);
+    r.p95 = percentile(r.samples, 0.95);
+    r.p99 = percentile(r.samples, 0.99);
+    r.mean = sum / r.samples.size();
+    return r;
+}
+
+class BenchReport {
+public:
+    void add(const BenchResult& r) { items.push_back(r); }
+    const std::vector<BenchResult>& results() const { return items; }
+
+    // 打印第 from 条起的结果
+    void printTable(std::ostream& os, size_t from = 0) const {
+        os << std::left << std::setw(16) << "name" << std::setw(16) << "dataset" << std::setw(12) << "dist" << std::right
+           << std::setw(10) << "n" << std::setw(12) << "median" << std::setw(12) << "p95"
+           << std::setw(12) << "p99" << "  unit\n";
+        std::ios::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        os << std::fixed << std::setprecision(3);
+        for (size_t i = from; i < items.size(); ++i) {
+            const BenchResult& r = items[i];
+            os << std::left << std::setw(16) << r.name << std::setw(16) << (r.dataset.empty() ? "-" : r.dataset)
+               << std::setw(12) << r.distribution << std::right
+               << std::setw(10) << r.n << std::setw(12) << r.median << std::setw(12) << r.p95
+               << std::setw(12) << r.p99 << "  " << r.unit << "\n";
+        }
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    void writeCsv(std::ostream& os) const {
+        os << "name,dataset,distribution,n,unit,samples,min,median,p95,p99,mean\n";
+        for (const auto& r : items) {
+            os << csvField(r.name) << ',' << csvField(r.dataset) << ',' << r.distribution << ',' << r.n << ',' << r.unit << ','
+               << r.samples.size() << ',' << r.min << ',' << r.median << ',' << r.p95 << ','
+               << r.p99 << ',' << r.mean << '\n';
+        }
+    }
+
+    void writeJson(std::ostream& os) const {
+        os << "[\n";
+        for (size_t i = 0; i < items.size(); ++i) {
+            const BenchResult& r = items[i];
+            os << "  {\"name\": \"" << jsonEscape(r.name) << "\", \"dataset\": \"" << jsonEscape(r.dataset)
+               << "\", \"distribution\": \"" << r.distribution
+               << "\", \"n\": " << r.n << ", \"unit\": \"" << r.unit << "\", \"samples\": [";
+            for (size_t k = 0; k < r.samples.size(); ++k) os << (k ? ", " : "") << r.samples[k];
+            os << "], \"min\": " << r.min << ", \"median\": " << r.median << ", \"p95\": " << r.p95
+               << ", \"p99\": " << r.p99 << ", \"mean\": " << r.mean << "}"
+               << (i + 1 < items.size() ? "," : "") << "\n";
+        }
+        os << "]\n";
+    }
+
+private:
+    std::vector<BenchResult> items;
+
+    static std::string csvField(const std::string& s) {
+        if (s.find_first_of(",\"\n") == std::string::npos) return s;
+        std::string out = "\"";
+        for (char c : s) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    static std::string jsonEscape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+};
+
+// 一种待测排序；maxN 限制 O(n^2) 算法参与的最大规模
+template <class T>
+struct SortCase {
+    std::string name;
+    std::function<void(std::vector<T>&)> sort;
+    size_t maxN;
+};
+
+// 对每个规模、每种分布、每种排序采样；makeSorted(n) 返回已排好序的 n 个样本
+template <class T, class MakeSorted>
+void benchmarkSorts(BenchReport& report, const BenchConfig& cfg, const std::vector<size_t>& sizes,
+                    MakeSorted makeSorted, const std::vector<SortCase<T> >& cases,
+                    const std::vector<InputDistribution>& dists = allDistributions(),
+                    const std::string& dataset = "") {
+    for (size_t n : sizes) {
+        std::vector<T> sorted = makeSorted(n);
+        for (InputDistribution d : dists) {
+            std::vector<T> input = arrangeInput(sorted, d, cfg.seed);
+            std::vector<T> work;
+            for (const auto& c : cases) {
+                if (n > c.maxN) continue;
+                BenchResult r = runBenchmark(c.name, distributionName(d), n, cfg,
+                                             [&] { work = input; }, [&] { c.sort(work); });
+                r.dataset = dataset;
+                report.add(r);
+            }
+        }
+    }
+}
+
+// 命令行：--csv=路径、--json=路径、--cycles、--samples=N
+struct BenchOutput {
+    std::string csvPath;
+    std::string jsonPath;
+    bool cycles;
+    int samples;  // 0 表示沿用 BenchConfig 的默认值
+    BenchOutput() : cycles(false), samples(0) {}
+};
+
+inline BenchOutput parseBenchArgs(int argc, char** argv) {
+    BenchOutput out;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--csv=", 6) == 0) out.csvPath = argv[i] + 6;
+        else if (strncmp(argv[i], "--json=", 7) == 0) out.jsonPath = argv[i] + 7;
+        else if (strcmp(argv[i], "--cycles") == 0) out.cycles = true;
+        else if (strncmp(argv[i], "--samples=", 10) == 0) out.samples = std::max(1, atoi(argv[i] + 10));
+    }
+    return out;
+}
+
+// 按命令行调整计时方式与采样次数
+inline BenchConfig benchConfigFor(const BenchOutput& out) {
+    BenchConfig cfg;
+    cfg.clock = out.cycles ? CYCLE_COUNTER : STEADY_CLOCK;
+    if (out.samples > 0) cfg.samples = out.samples;
+    return cfg;
+}
+
+inline void writeBenchOutput(const BenchReport& report, const BenchOutput& out) {
+    if (!out.csvPath.empty()) {
+        std::ofstream f(out.csvPath.c_str());
+        report.writeCsv(f);
+        if (!f) std::cerr << "cannot write " << out.csvPath << "\n";
+    }
+    if (!out.jsonPath.empty()) {
+        std::ofstream f(out.jsonPath.c_str());
+        report.writeJson(f);
+        if (!f) std::cerr << "cannot write " << out.jsonPath << "\n";
+    }
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef DS2025_PARALLEL_MERGE_SORT_H
+#define DS2025_PARALLEL_MERGE_SORT_H
+
+// 并行归并排序：递归两半分别作为任务分叉到工作窃取线程池，
+// 规模不超过 grain 时交给调用方提供的顺序排序（leaf），
+// 归并时用归并路径（merge path）把输出切成多段并行归并。
+// 原数组与 scratch 按递归层次交替作为目标，不做额外的拷回。
+
+#include <algorithm>
+#include <cstddef>
+
+#include "task_pool.h"
+
+// 归并路径划分：稳定归并的前 d 个输出中来自 a 的元素个数（相等时 a 优先）
+template <class T, class Less>
+size_t mergePathSplit(const T* a, size_t n1, const T* b, size_t n2, size_t d, Less less) {
+    size_t lo = d > n2 ? d - n2 : 0;
+    size_t hi = d < n1 ? d : n1;
+    while (lo < hi) {
+        size_t m = lo + (hi - lo) / 2;
+        if (!less(b[d - m - 1], a[m])) {
+            lo = m + 1;
+        } else {
+            hi = m;
+        }
+    }
+    return lo;
+}
+
+template <class T, class Less>
+void sequentialMerge(const T* a, size_t n1, const T* b, size_t n2, T* out, Less less) {
+    size_t i = 0, j = 0, k = 0;
+    while (i < n1 && j < n2) {
+        if (less(b[j], a[i])) {
+            out[k++] = b[j++];
+        } else {
+            out[k++] = a[i++];
+        }
+    }
+    while (i < n1) out[k++] = a[i++];
+    while (j < n2) out[k++] = b[j++];
+}
+
+template <class T, class Less>
+void parallelMerge(const T* a, size_t n1, const T* b, size_t n2, T* out,
+                   Less less, WorkStealingPool& pool, size_t grain) {
+    size_t total = n1 + n2;
+    size_t parts = std::min<size_t>(pool.size(), total / (grain ? grain : 1));
+    if (parts <= 1) {
+        sequentialMerge(a, n1, b, n2, out, less);
+        return;
+    }
+    TaskGroup group(pool);
+    for (size_t p = 0; p < parts; ++p) {
+        size_t d0 = total * p / parts, d1 = total * (p + 1) / parts;
+        group.run([=] {
+            size_t i0 = mergePathSplit(a, n1, b, n2, d0, less);
+            size_t i1 = mergePathSplit(a, n1, b, n2, d1, less);
+            sequentialMerge(a + i0, i1 - i0, b + (d0 - i0), (d1 - i1) - (d0 - i0), out + d0, less);
+        });
+    }
+    group.wait();
+}
+
+// 排序 a[0, n)；toScratch 为真时结果写入 b，否则留在 a
+template <class T, class Less, class LeafSort>
+void parallelMergeSortStep(T* a, T* b, size_t n, bool toScratch,
+                           Less less, LeafSort leaf, WorkStealingPool& pool, size_t grain) {
+    if (n <= grain || n < 2) {
+        leaf(a, b, n);
+        if (toScratch) std::copy(a, a + n, b);
+        return;
+    }
+    size_t half = n / 2;
+    {
+        TaskGroup group(pool);
+        group.run([=, &pool] {
+            parallelMergeSortStep(a, b, half, !toScratch, less, leaf, pool, grain);
+        });
+        parallelMergeSortStep(a + half, b + half, n - half, !toScratch, less, leaf, pool, grain);
+        group.wait();
+    }
+    const T* src = toScratch ? a : b;
+    T* dst = toScratch ? b : a;
+    parallelMerge(src, half, src + half, n - half, dst, less, pool, grain);
+}
+
+// leaf(T* data, T* tmp, size_t n) 负责顺序排序一小段，tmp 为同样长度的缓冲区
+template <class T, class Less, class LeafSort>
+void parallelMergeSortRange(T* data, T* scratch, size_t n,
+                            Less less, LeafSort leaf, WorkStealingPool& pool, size_t grain) {
+    parallelMergeSortStep(data, scratch, n, false, less, leaf, pool, grain);
+}
+
+#endif
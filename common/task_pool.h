@@ -0,0 +1,210 @@
+#ifndef DS2025_TASK_POOL_H
+#define DS2025_TASK_POOL_H
+
+// 工作窃取线程池：每个工作线程有自己的双端队列，
+// 自己从队尾压入/弹出（LIFO，缓存友好），空闲时从其他线程的队首窃取（FIFO，窃取大任务）。
+// 外部线程提交的任务进入共享的注入队列。
+// TaskGroup 提供 fork/join：wait() 期间调用线程会帮忙执行任务，嵌套分叉不会死锁。
+// 任务抛出的异常由所属 TaskGroup 记下，在 wait() 里重新抛出。
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+class WorkStealingPool {
+public:
+    // threads 为工作线程数；0 表示使用硬件并发数
+    // 最后一个队列是外部线程使用的注入队列
+    explicit WorkStealingPool(unsigned threads = 0)
+        : queues(resolveThreads(threads) + 1), stopping(false), queued(0) {
+        threads = unsigned(queues.size() - 1);
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, i));
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        sleepCv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    unsigned size() const { return unsigned(workers.size()); }
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCv;
+    bool stopping;
+    std::atomic<int> queued;
+
+    static unsigned resolveThreads(unsigned threads) {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        return threads == 0 ? 1 : threads;
+    }
+
+    // 当前线程在哪个池、哪个队列；外部线程为 nullptr
+    static WorkStealingPool*& currentPool() {
+        static thread_local WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+    static unsigned& currentIndex() {
+        static thread_local unsigned index = 0;
+        return index;
+    }
+
+    unsigned localIndex() {
+        return currentPool() == this ? currentIndex() : unsigned(queues.size() - 1);
+    }
+
+    // queued 在 sleepMutex 下递增：等待者检查条件与进入等待之间不会漏掉这次通知
+    void push(Task task) {
+        Queue& q = queues[localIndex()];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued.fetch_add(1);
+        }
+        sleepCv.notify_one();
+    }
+
+    // 先取自己的队尾，再依次从其他队列的队首窃取
+    bool tryPop(Task& out) {
+        unsigned self = localIndex(), n = unsigned(queues.size());
+        {
+            Queue& q = queues[self];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                out = std::move(q.tasks.back());
+                q.tasks.pop_back();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < n; ++k) {
+            Queue& q = queues[(self + k) % n];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (!q.tasks.empty()) {
+                out = std::move(q.tasks.front());
+                q.tasks.pop_front();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void execute(Task& task);
+
+    void workerLoop(unsigned index) {
+        currentPool() = this;
+        currentIndex() = index;
+        Task task;
+        while (true) {
+            if (tryPop(task)) {
+                execute(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            if (stopping) return;
+            sleepCv.wait(lock, [this] { return stopping || queued.load() > 0; });
+        }
+    }
+};
+
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& p) : pool(p), pending(0) {}
+    ~TaskGroup() { join(); }
+
+    void run(std::function<void()> fn) {
+        pending.fetch_add(1);
+        WorkStealingPool::Task task;
+        task.fn = std::move(fn);
+        task.group = this;
+        pool.push(std::move(task));
+    }
+
+    // 等待本组任务完成；等待期间执行池中的任意任务。有任务抛出异常时，重新抛出第一个
+    void wait() {
+        join();
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+
+private:
+    friend class WorkStealingPool;
+    WorkStealingPool& pool;
+    std::atomic<int> pending;
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    void join() {
+        WorkStealingPool::Task task;
+        while (pending.load() > 0) {
+            if (pool.tryPop(task)) {
+                pool.execute(task);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void fail(std::exception_ptr e) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = e;
+    }
+};
+
+// 加速比测试的线程数：1、2、4…… 直到硬件并发数；硬件并发数不是 2 的幂（如 12、24）时最后再测它本身
+inline std::vector<unsigned> scalingThreadCounts() {
+    unsigned maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+// 无论任务是否抛出异常都要递减 pending，否则 wait() 会一直等下去
+inline void WorkStealingPool::execute(Task& task) {
+    TaskGroup* group = task.group;
+    try {
+        task.fn();
+    } catch (...) {
+        group->fail(std::current_exception());
+    }
+    task.fn = nullptr;
+    group->pending.fetch_sub(1);
+}
+
+#endif
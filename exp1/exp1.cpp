@@ -1,6 +1,8 @@
 #include <iostream>
 #include <vector>
 #include <random>
+#include <map>
+#include <string>
 #include <algorithm>
 #include <ctime>
 #include <cmath>
@@ -9,6 +11,31 @@
 #include <cstdlib>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <limits.h>
+#include <float.h>
+#include <chrono>
+#include <thread>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <iterator>
+#include <errno.h>
+#if defined(__AVX2__) || defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+#include "../common/benchmark.h"
+#include "../common/parallel_merge_sort.h"
 
 using namespace std;
 
@@ -91,6 +118,173 @@ void mergeSort(vector<Complex>& vec) {
         mergeSortHelper(vec, 0, vec.size() - 1);
 }
 
+// 自底向上归并排序：先对长度为 RUN 的小段做插入排序，再在原数组与一块缓冲区之间来回归并，
+// 整个排序只使用一块缓冲区；调用方可传入 scratch 反复复用，容量足够时不再分配内存
+static const size_t MERGE_RUN = 32;
+
+static void insertionSortRange(Complex* a, size_t lo, size_t hi) {
+    for (size_t i = lo + 1; i < hi; ++i) {
+        Complex key = a[i];
+        size_t j = i;
+        while (j > lo && compareComplex(key, a[j - 1])) {
+            a[j] = a[j - 1];
+            --j;
+        }
+        a[j] = key;
+    }
+}
+
+static void mergeRuns(const Complex* src, Complex* dst, size_t left, size_t mid, size_t right) {
+    size_t i = left, j = mid, k = left;
+    while (i < mid && j < right) {
+        if (compareComplex(src[j], src[i])) {
+            dst[k++] = src[j++];
+        } else {
+            dst[k++] = src[i++];
+        }
+    }
+    while (i < mid) dst[k++] = src[i++];
+    while (j < right) dst[k++] = src[j++];
+}
+
+// 对 a[0, n) 排序，tmp 为至少 n 个元素的缓冲区
+void bottomUpSortRange(Complex* a, Complex* tmp, size_t n) {
+    if (n < 2) return;
+    for (size_t lo = 0; lo < n; lo += MERGE_RUN) {
+        insertionSortRange(a, lo, min(lo + MERGE_RUN, n));
+    }
+
+    Complex* src = a;
+    Complex* dst = tmp;
+    for (size_t width = MERGE_RUN; width < n; width *= 2) {
+        for (size_t left = 0; left < n; left += 2 * width) {
+            size_t mid = min(left + width, n);
+            size_t right = min(left + 2 * width, n);
+            mergeRuns(src, dst, left, mid, right);
+        }
+        swap(src, dst);
+    }
+    if (src != a) {
+        copy(src, src + n, a);
+    }
+}
+
+void mergeSortBottomUp(vector<Complex>& vec, vector<Complex>& scratch) {
+    if (scratch.size() < vec.size()) scratch.resize(vec.size());
+    bottomUpSortRange(vec.data(), scratch.data(), vec.size());
+}
+
+void mergeSortBottomUp(vector<Complex>& vec) {
+    vector<Complex> scratch;
+    mergeSortBottomUp(vec, scratch);
+}
+
+// 并行归并排序：不超过 grain 个元素的子段用 bottomUpSortRange 顺序排序
+void parallelMergeSort(vector<Complex>& vec, WorkStealingPool& pool, size_t grain = 1 << 14) {
+    vector<Complex> scratch(vec.size());
+    parallelMergeSortRange(vec.data(), scratch.data(), vec.size(),
+                           [](const Complex& a, const Complex& b) { return compareComplex(a, b); },
+                           bottomUpSortRange, pool, grain);
+}
+
+// 预计算排序键（decorate-sort-undecorate）：每个元素只开方一次，
+// 比较时直接用缓存的模长，比较规则与 compareComplex 相同（含 1e-9 的实部次序规则）。
+// 用 stable_sort，相等元素保持输入次序；mergeSort 的 merge 在相等时先取右半边，并不稳定，
+// 所以相等元素（如 (3,4) 与 (3,-4)）的相对次序可能与 mergeSort 不同
+struct ModulusKey {
+    double mod;
+    double real;
+    size_t idx;
+};
+
+void keyedSort(vector<Complex>& vec) {
+    size_t n = vec.size();
+    vector<ModulusKey> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i].mod = vec[i].modulus();
+        keys[i].real = vec[i].real;
+        keys[i].idx = i;
+    }
+    stable_sort(keys.begin(), keys.end(), [](const ModulusKey& a, const ModulusKey& b) {
+        if (abs(a.mod - b.mod) < 1e-9) {
+            return a.real < b.real;
+        }
+        return a.mod < b.mod;
+    });
+
+    vector<Complex> sorted;
+    sorted.reserve(n);
+    for (size_t i = 0; i < n; ++i) sorted.push_back(vec[keys[i].idx]);
+    vec.swap(sorted);
+}
+
+// LSD 基数排序：把 |z|^2（主键）和 real（次键）映射为保序的 64 位无符号整数，每趟 11 位。
+// 非负 double 的位模式本身保序；有符号 double 取反负数、给正数置符号位即可保序。
+// 注意：排序严格按 (|z|^2, real)，模长相差小于 1e-9 但不相等的元素仍按模长排序，
+// 这一点与 compareComplex 的容差规则不同（容差关系不满足传递性，无法编码为键）。
+struct RadixItem {
+    uint64_t key;
+    size_t idx;
+};
+
+static uint64_t doubleToOrderedBits(double d) {
+    uint64_t u;
+    memcpy(&u, &d, sizeof(u));
+    return (u & 0x8000000000000000ULL) ? ~u : (u | 0x8000000000000000ULL);
+}
+
+static void radixPasses(vector<RadixItem>& items, vector<RadixItem>& buf) {
+    const int BITS = 11, BUCKETS = 1 << BITS, PASSES = (64 + BITS - 1) / BITS;
+    size_t n = items.size();
+    vector<size_t> count(size_t(PASSES) * BUCKETS, 0);
+    for (size_t i = 0; i < n; ++i) {
+        for (int p = 0; p < PASSES; ++p) {
+            count[p * BUCKETS + ((items[i].key >> (p * BITS)) & (BUCKETS - 1))]++;
+        }
+    }
+    for (int p = 0; p < PASSES; ++p) {
+        size_t* cnt = &count[p * BUCKETS];
+        // 所有键在这一位上相同，本趟可以跳过
+        if (cnt[(items[0].key >> (p * BITS)) & (BUCKETS - 1)] == n) continue;
+        size_t sum = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            size_t c = cnt[b];
+            cnt[b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            buf[cnt[(items[i].key >> (p * BITS)) & (BUCKETS - 1)]++] = items[i];
+        }
+        items.swap(buf);
+    }
+}
+
+void radixSort(vector<Complex>& vec) {
+    size_t n = vec.size();
+    if (n < 2) return;
+    vector<RadixItem> items(n), buf(n);
+
+    // 先按次键排序，再按主键稳定排序
+    for (size_t i = 0; i < n; ++i) {
+        items[i].key = doubleToOrderedBits(vec[i].real);
+        items[i].idx = i;
+    }
+    radixPasses(items, buf);
+    for (size_t i = 0; i < n; ++i) {
+        const Complex& c = vec[items[i].idx];
+        double sq = c.real * c.real + c.imag * c.imag;
+        uint64_t u;
+        memcpy(&u, &sq, sizeof(u));
+        items[i].key = u;
+    }
+    radixPasses(items, buf);
+
+    vector<Complex> sorted;
+    sorted.reserve(n);
+    for (size_t i = 0; i < n; ++i) sorted.push_back(vec[items[i].idx]);
+    vec.swap(sorted);
+}
+
 vector<Complex> generateRandomComplexVector(size_t n, unsigned seed = 0) {
     mt19937 gen(seed == 0 ? unsigned(time(nullptr)) : seed);
     uniform_real_distribution<double> dis(-10.0, 10.0);
@@ -129,6 +323,192 @@ vector<Complex> uniqueComplex(vector<Complex> vec) {
     return vec;
 }
 
+// 基于哈希的原地去重：把 (real, imag) 量化到边长 6.4e-8 的网格，每个保留元素登记在自己的格子里。
+// 与 c 相等（各分量相差小于 1e-9）的点只可能落在 c 的 ±1e-9 邻域覆盖的格子中，
+// 该邻域绝大多数情况下只覆盖一个格子，因此通常只需一次哈希探测，再用 operator== 精确判定，
+// 保持与原有容差语义一致。表项只存格子哈希的高 32 位和元素下标，8 字节一项。
+// STABLE_ORDER 保留每组首次出现的元素并保持原顺序；ANY_ORDER 用末尾元素填补空位，写入更少。
+enum UniqueMode { STABLE_ORDER, ANY_ORDER };
+
+// 网格坐标；|x| 很大时 1e-9 已小于 ulp 的一半，相等即位模式相等，直接用位模式
+static int64_t gridCell(double x) {
+    if (abs(x) < 4e9) return int64_t(floor(x / 6.4e-8));
+    int64_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+class GridTable {
+public:
+    explicit GridTable(size_t n) {
+        size_t cap = 16;
+        while (cap < 2 * n) cap <<= 1;
+        slots.assign(cap, Slot());
+        mask = cap - 1;
+    }
+
+    // 对格子 (cx, cy) 中的每个下标调用 visit，visit 返回 true 时提前结束并返回 true
+    template <class Visit>
+    bool forEach(int64_t cx, int64_t cy, Visit visit) const {
+        uint64_t h = hash(cx, cy);
+        uint32_t tag = uint32_t(h >> 32);
+        for (size_t i = size_t(h) & mask; slots[i].idx != EMPTY; i = (i + 1) & mask) {
+            if (slots[i].tag == tag && visit(slots[i].idx)) return true;
+        }
+        return false;
+    }
+
+    void insert(int64_t cx, int64_t cy, uint32_t idx) {
+        uint64_t h = hash(cx, cy);
+        size_t i = size_t(h) & mask;
+        while (slots[i].idx != EMPTY) i = (i + 1) & mask;
+        slots[i].tag = uint32_t(h >> 32);
+        slots[i].idx = idx;
+    }
+
+    static const uint32_t EMPTY = 0xFFFFFFFFu;
+
+private:
+    struct Slot {
+        uint32_t tag, idx;
+        Slot() : tag(0), idx(EMPTY) {}
+    };
+    vector<Slot> slots;
+    size_t mask;
+
+    static uint64_t hash(int64_t cx, int64_t cy) {
+        uint64_t h = uint64_t(cx) * 0x9E3779B97F4A7C15ULL ^ uint64_t(cy) * 0xC2B2AE3D27D4EB4FULL;
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return h ^ (h >> 29);
+    }
+};
+
+void uniqueComplexInPlace(vector<Complex>& vec, UniqueMode mode = STABLE_ORDER) {
+    // 下标用 32 位存储，超出时退回排序去重
+    if (vec.size() >= GridTable::EMPTY) {
+        vec = uniqueComplex(vec);
+        return;
+    }
+    GridTable table(vec.size());
+    const double reach = 1e-9 * (1 + 1e-6); // 略放宽邻域，抵消 x±1e-9 的舍入
+
+    // 邻域内是否已有与 c 相等的保留元素
+    auto isDuplicate = [&](const Complex& c) {
+        int64_t x0 = gridCell(c.real - reach), x1 = gridCell(c.real + reach);
+        int64_t y0 = gridCell(c.imag - reach), y1 = gridCell(c.imag + reach);
+        for (int64_t cx = x0; cx <= x1; ++cx) {
+            for (int64_t cy = y0; cy <= y1; ++cy) {
+                if (table.forEach(cx, cy, [&](uint32_t k) { return vec[k] == c; })) return true;
+            }
+        }
+        return false;
+    };
+
+    if (mode == STABLE_ORDER) {
+        size_t w = 0;
+        for (size_t i = 0; i < vec.size(); ++i) {
+            Complex c = vec[i];
+            if (isDuplicate(c)) continue;
+            vec[w] = c;
+            table.insert(gridCell(c.real), gridCell(c.imag), uint32_t(w++));
+        }
+        vec.resize(w);
+    } else {
+        size_t i = 0;
+        while (i < vec.size()) {
+            if (isDuplicate(vec[i])) {
+                vec[i] = vec.back();
+                vec.pop_back();
+            } else {
+                table.insert(gridCell(vec[i].real), gridCell(vec[i].imag), uint32_t(i));
+                ++i;
+            }
+        }
+    }
+}
+
+// 去重对拍：基准点各出现 1~4 次并加抖动，抖动多数在 1e-9 以内，少数超出而形成相等链；
+// 基准点含普通点、网格边界上的点和 |x| >= 4e9（按位模式分格）的点。两种模式都要满足：
+// 每个输入都有与之相等的保留元素，保留元素两两不等，保留元素都取自输入；
+// STABLE_ORDER 还必须与朴素的逐个比较（保留首次出现、保持原顺序）结果完全相同。返回违反的条数
+size_t checkUniqueComplex(unsigned seed) {
+    mt19937 gen(seed);
+    uniform_real_distribution<double> small(-10.0, 10.0), big(4e9, 8e9), jitter(-6e-10, 6e-10);
+    vector<Complex> input;
+    for (int i = 0; i < 1500; ++i) {
+        Complex c;
+        switch (gen() % 3) {
+            case 0: c = Complex(small(gen), small(gen)); break;
+            case 1: c = Complex(6.4e-8 * (int(gen() % 2001) - 1000), 6.4e-8 * (int(gen() % 2001) - 1000)); break;
+            default: c = Complex(gen() % 2 ? big(gen) : -big(gen), small(gen)); break;
+        }
+        for (int k = int(gen() % 4); k >= 0; --k) input.emplace_back(c.real + jitter(gen), c.imag + jitter(gen));
+    }
+    shuffle(input.begin(), input.end(), gen);
+
+    vector<Complex> greedy;
+    for (const auto& c : input) {
+        if (find(greedy.begin(), greedy.end(), c) == greedy.end()) greedy.push_back(c);
+    }
+    auto byBits = [](const Complex& a, const Complex& b) { return a.real != b.real ? a.real < b.real : a.imag < b.imag; };
+    vector<Complex> sortedInput = input;
+    sort(sortedInput.begin(), sortedInput.end(), byBits);
+
+    size_t violations = 0;
+    for (UniqueMode mode : {STABLE_ORDER, ANY_ORDER}) {
+        vector<Complex> kept = input;
+        uniqueComplexInPlace(kept, mode);
+        for (const auto& c : input) violations += find(kept.begin(), kept.end(), c) == kept.end();
+        for (size_t i = 0; i < kept.size(); ++i) {
+            for (size_t j = i + 1; j < kept.size(); ++j) violations += kept[i] == kept[j];
+        }
+        vector<Complex> sortedKept = kept;
+        sort(sortedKept.begin(), sortedKept.end(), byBits);
+        violations += !includes(sortedInput.begin(), sortedInput.end(), sortedKept.begin(), sortedKept.end(), byBits);
+        if (mode == STABLE_ORDER) {
+            violations += kept.size() != greedy.size() ||
+                          !equal(kept.begin(), kept.end(), greedy.begin(), [](const Complex& a, const Complex& b) {
+                              return a.real == b.real && a.imag == b.imag;
+                          });
+        }
+    }
+    return violations;
+}
+
+// 去重性能：每个基准点平均出现 4 次、各分量抖动在 ±3e-10 以内，打乱顺序；
+// 与排序 + unique 对比。各方式都在 setup 中拷贝输入，计时只含去重本身
+void testUniqueComplex(BenchReport& report, const BenchConfig& cfg, size_t maxN) {
+    cout << "\n=== 复数去重 (排序 + unique 对比哈希原地去重) ===\n";
+    size_t first = report.results().size();
+    for (size_t n : geometricSizes(100000, maxN, 10)) {
+        mt19937 gen(cfg.seed);
+        uniform_real_distribution<double> dis(-10.0, 10.0), jitter(-3e-10, 3e-10);
+        vector<Complex> input;
+        input.reserve(n);
+        while (input.size() < n) {
+            Complex c(dis(gen), dis(gen));
+            for (int k = 0; k < 4 && input.size() < n; ++k) input.emplace_back(c.real + jitter(gen), c.imag + jitter(gen));
+        }
+        shuffle(input.begin(), input.end(), gen);
+
+        vector<Complex> work;
+        auto reset = [&] { work = input; };
+        size_t kept[3];
+        report.add(runBenchmark("sort+unique", "jittered", n, cfg, reset, [&] { kept[0] = uniqueComplex(std::move(work)).size(); }));
+        report.add(runBenchmark("hash-stable", "jittered", n, cfg, reset, [&] {
+            uniqueComplexInPlace(work, STABLE_ORDER);
+            kept[1] = work.size();
+        }));
+        report.add(runBenchmark("hash-any", "jittered", n, cfg, reset, [&] {
+            uniqueComplexInPlace(work, ANY_ORDER);
+            kept[2] = work.size();
+        }));
+        printf("n = %zu: 保留 排序 %zu, 哈希稳定 %zu, 哈希任意顺序 %zu\n", n, kept[0], kept[1], kept[2]);
+    }
+    report.printTable(cout, first);
+}
+
 vector<Complex> rangeFind(const vector<Complex>& sortedVec, double m1, double m2) {
     vector<Complex> result;
     for (const auto& c : sortedVec) {
@@ -140,384 +520,2660 @@ vector<Complex> rangeFind(const vector<Complex>& sortedVec, double m1, double m2
     return result;
 }
 
-void testSortingPerformance(const vector<Complex>& baseVec) {
-    cout << "\n=== 排序性能测试 (n = " << baseVec.size() << ") ===\n";
+// 按模长索引的有序集合：主数组按 (|z|, real) 严格有序并缓存每个元素的模长，
+// 插入先二分插入有序的插入日志，删除在日志中直接删、在主数组中打删除标记；
+// 查找与区间查询分别对主数组和日志二分，不触发归并。只有日志或删除标记达到阈值时
+// 才一次性归并，摊还代价为 O(log n) 加上日志内的搬移。
+// 注：这里用精确的 (|z|, real) 作为顺序，而不是 compareComplex 的 1e-9 容差规则，
+// 这样模长数组单调，区间边界的二分结果与 rangeFind 的逐个判断完全一致。
+class ComplexView {
+public:
+    ComplexView(const Complex* f = nullptr, const Complex* l = nullptr) : first(f), last(l) {}
+    const Complex* begin() const { return first; }
+    const Complex* end() const { return last; }
+    size_t size() const { return size_t(last - first); }
+    bool empty() const { return first == last; }
+    const Complex& operator[](size_t i) const { return first[i]; }
+private:
+    const Complex* first;
+    const Complex* last;
+};
+
+// 有序序列中的位置：主数组下标与插入日志下标
+struct ComplexBound {
+    size_t main;
+    size_t log;
+};
+
+// 区间查询结果：主数组与插入日志中各一段视图，不拷贝元素；
+// 迭代时按 (|z|, real) 归并两段并跳过已删除元素。视图在下一次修改前有效
+class ComplexRange {
+public:
+    ComplexRange(ComplexView mainPart, const double* mainMods, const char* mainDead, bool anyDead,
+                 ComplexView logPart, const double* logMods)
+        : mainPart(mainPart), logPart(logPart), mainMods(mainMods), logMods(logMods),
+          mainDead(anyDead ? mainDead : nullptr), live(mainPart.size() + logPart.size()) {
+        if (this->mainDead) {
+            for (size_t i = 0; i < mainPart.size(); ++i) live -= size_t(mainDead[i] != 0);
+        }
+    }
+
+    class iterator {
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef Complex value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const Complex* pointer;
+        typedef const Complex& reference;
+
+        iterator(const ComplexRange* r, size_t i, size_t j) : r(r), i(i), j(j) { skipDead(); }
+        const Complex& operator*() const { return fromMain() ? r->mainPart[i] : r->logPart[j]; }
+        const Complex* operator->() const { return &**this; }
+        iterator& operator++() {
+            if (fromMain()) ++i;
+            else ++j;
+            skipDead();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const iterator& o) const { return i == o.i && j == o.j; }
+        bool operator!=(const iterator& o) const { return !(*this == o); }
+    private:
+        const ComplexRange* r;
+        size_t i, j;
+        bool fromMain() const {
+            if (i == r->mainPart.size()) return false;
+            if (j == r->logPart.size()) return true;
+            double a = r->mainMods[i], b = r->logMods[j];
+            return a != b ? a < b : !(r->logPart[j].real < r->mainPart[i].real);
+        }
+        void skipDead() {
+            while (r->mainDead && i < r->mainPart.size() && r->mainDead[i]) ++i;
+        }
+    };
+
+    iterator begin() const { return iterator(this, 0, 0); }
+    iterator end() const { return iterator(this, mainPart.size(), logPart.size()); }
+    size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+
+private:
+    ComplexView mainPart, logPart;
+    const double* mainMods;
+    const double* logMods;
+    const char* mainDead;  // 区间内没有删除标记时为空
+    size_t live;
+};
+
+class ComplexSet {
+public:
+    ComplexSet() : deadCount(0) {}
+    explicit ComplexSet(const vector<Complex>& vec) : deadCount(0) {
+        insertBulk(vec);
+        flush();
+    }
+
+    size_t size() const { return items.size() - deadCount + logItems.size(); }
+    bool empty() const { return size() == 0; }
+
+    bool contains(const Complex& c) const {
+        return findLive(c) != NPOS || findLogged(c) != NPOS;
+    }
+
+    void insert(const Complex& c) {
+        double mod = c.modulus();
+        size_t pos = upperPos(logMods, logItems, mod, c);
+        logItems.insert(logItems.begin() + pos, c);
+        logMods.insert(logMods.begin() + pos, mod);
+        if (logItems.size() >= logLimit()) flush();
+    }
+
+    // 批量插入：整批排序后与日志归并一次
+    void insertBulk(const vector<Complex>& vec) {
+        if (vec.empty()) return;
+        vector<Complex> added;
+        vector<double> addedMods;
+        sortByModulus(vec, added, addedMods);
+        vector<Complex> mergedItems;
+        vector<double> mergedMods;
+        mergeSorted(logItems, logMods, nullptr, added, addedMods, mergedItems, mergedMods);
+        logItems.swap(mergedItems);
+        logMods.swap(mergedMods);
+        if (logItems.size() >= logLimit()) flush();
+    }
+
+    // 删除一个与 c 相等（1e-9 容差）的元素
+    bool remove(const Complex& c) {
+        size_t pos = findLogged(c);
+        if (pos != NPOS) {
+            logItems.erase(logItems.begin() + pos);
+            logMods.erase(logMods.begin() + pos);
+            return true;
+        }
+        pos = findLive(c);
+        if (pos == NPOS) return false;
+        dead[pos] = 1;
+        if (++deadCount >= deadLimit()) flush();
+        return true;
+    }
+
+    size_t removeBulk(const vector<Complex>& vec) {
+        size_t removed = 0;
+        for (const auto& c : vec) {
+            if (remove(c)) ++removed;
+        }
+        return removed;
+    }
+
+    // 第一个模长 >= m / > m 的位置，主数组与日志分别二分
+    ComplexBound lowerBound(double m) const {
+        ComplexBound b = {size_t(lower_bound(mods.begin(), mods.end(), m) - mods.begin()),
+                          size_t(lower_bound(logMods.begin(), logMods.end(), m) - logMods.begin())};
+        return b;
+    }
+    ComplexBound upperBound(double m) const {
+        ComplexBound b = {size_t(upper_bound(mods.begin(), mods.end(), m) - mods.begin()),
+                          size_t(upper_bound(logMods.begin(), logMods.end(), m) - logMods.begin())};
+        return b;
+    }
+
+    ComplexRange slice(ComplexBound i, ComplexBound j) const {
+        return ComplexRange(ComplexView(items.data() + i.main, items.data() + j.main), mods.data() + i.main,
+                            dead.data() + i.main, deadCount > 0,
+                            ComplexView(logItems.data() + i.log, logItems.data() + j.log), logMods.data() + i.log);
+    }
+
+    // 模长在 [m1, m2) 内的元素，返回视图不拷贝；视图在下一次修改前有效
+    ComplexRange range(double m1, double m2) const {
+        ComplexBound i = lowerBound(m1), j = lowerBound(m2);
+        j.main = max(j.main, i.main);
+        j.log = max(j.log, i.log);
+        return slice(i, j);
+    }
+
+    // 把插入日志与主数组归并，同时清除删除标记
+    void flush() {
+        if (logItems.empty() && deadCount == 0) return;
+        vector<Complex> mergedItems;
+        vector<double> mergedMods;
+        mergeSorted(items, mods, deadCount ? dead.data() : nullptr, logItems, logMods, mergedItems, mergedMods);
+        items.swap(mergedItems);
+        mods.swap(mergedMods);
+        logItems.clear();
+        logMods.clear();
+        dead.assign(items.size(), 0);
+        deadCount = 0;
+    }
+
+private:
+    static const size_t NPOS = size_t(-1);
+
+    vector<Complex> items;    // 主数组，按 (|z|, real) 有序
+    vector<double> mods;      // items[i].modulus() 的缓存
+    vector<char> dead;        // 删除标记
+    size_t deadCount;
+    vector<Complex> logItems; // 插入日志，同样按 (|z|, real) 有序
+    vector<double> logMods;
+
+    static bool lessKey(const ModulusKey& a, const ModulusKey& b) {
+        if (a.mod != b.mod) return a.mod < b.mod;
+        return a.real < b.real;
+    }
+    static bool lessEntry(double modA, const Complex& a, double modB, const Complex& b) {
+        if (modA != modB) return modA < modB;
+        return a.real < b.real;
+    }
+
+    static void sortByModulus(const vector<Complex>& vec, vector<Complex>& out, vector<double>& outMods) {
+        vector<ModulusKey> keys(vec.size());
+        for (size_t i = 0; i < vec.size(); ++i) {
+            keys[i].mod = vec[i].modulus();
+            keys[i].real = vec[i].real;
+            keys[i].idx = i;
+        }
+        sort(keys.begin(), keys.end(), lessKey);
+        out.reserve(keys.size());
+        outMods.reserve(keys.size());
+        for (const auto& k : keys) {
+            out.push_back(vec[k.idx]);
+            outMods.push_back(k.mod);
+        }
+    }
+
+    // 归并两段有序序列；aDead 非空时跳过 a 中已删除的元素，相等时 a 在前
+    static void mergeSorted(const vector<Complex>& a, const vector<double>& aMods, const char* aDead,
+                            const vector<Complex>& b, const vector<double>& bMods,
+                            vector<Complex>& out, vector<double>& outMods) {
+        out.reserve(a.size() + b.size());
+        outMods.reserve(a.size() + b.size());
+        size_t i = 0, j = 0;
+        while (i < a.size() || j < b.size()) {
+            if (i < a.size() && aDead && aDead[i]) {
+                ++i;
+                continue;
+            }
+            bool takeA = j == b.size() || (i < a.size() && !lessEntry(bMods[j], b[j], aMods[i], a[i]));
+            if (takeA) {
+                out.push_back(a[i]);
+                outMods.push_back(aMods[i]);
+                ++i;
+            } else {
+                out.push_back(b[j]);
+                outMods.push_back(bMods[j]);
+                ++j;
+            }
+        }
+    }
+
+    // 第一个排在 (mod, c.real) 之后的位置
+    static size_t upperPos(const vector<double>& ms, const vector<Complex>& xs, double mod, const Complex& c) {
+        size_t lo = 0, hi = ms.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (lessEntry(mod, c, ms[mid], xs[mid])) hi = mid;
+            else lo = mid + 1;
+        }
+        return lo;
+    }
+
+    // 日志阈值约为 8√n：日志内插入的搬移代价 O(L) 与归并的摊还代价 O(n / L) 大致平衡
+    size_t logLimit() const { return max(size_t(1024), size_t(8 * sqrt(double(items.size())))); }
+    // 删除标记只占主数组的位置，随规模线性放宽
+    size_t deadLimit() const { return max(size_t(1024), items.size() / 32); }
+
+    // 在有序序列中查找相等元素；相等（1e-9 容差）意味着真实模长相差不超过约 1.5e-9，
+    // 但两边算出的模长各带约 2 ulp 的舍入误差，|z| 达百万量级时已超过固定余量，按模长放宽窗口
+    static size_t findIn(const vector<double>& ms, const vector<Complex>& xs, const char* deadFlags,
+                         const Complex& c) {
+        double mod = c.modulus(), slack = 2e-9 + 4 * DBL_EPSILON * mod;
+        size_t i = size_t(lower_bound(ms.begin(), ms.end(), mod - slack) - ms.begin());
+        for (; i < xs.size() && ms[i] <= mod + slack; ++i) {
+            if (!(deadFlags && deadFlags[i]) && xs[i] == c) return i;
+        }
+        return NPOS;
+    }
+    size_t findLive(const Complex& c) const { return findIn(mods, items, dead.data(), c); }
+    size_t findLogged(const Complex& c) const { return findIn(logMods, logItems, nullptr, c); }
+};
+
+bool findComplex(const ComplexSet& set, const Complex& target) {
+    return set.contains(target);
+}
+
+void insertComplex(ComplexSet& set, const Complex& c) {
+    set.insert(c);
+}
+
+bool removeComplex(ComplexSet& set, const Complex& c) {
+    return set.remove(c);
+}
+
+ComplexRange rangeFind(const ComplexSet& set, double m1, double m2) {
+    return set.range(m1, m2);
+}
+
+// 有序集合与 vector<Complex> 参照实现对拍：随机混合插入、批量插入、删除、查找、区间查询和归并，
+// 集合保持几千个元素，使插入日志与删除标记经常同时存在。点取自彼此远离的候选池（含 |z| 达数百万的点），
+// 查找和删除用各分量挪动 1 ulp 的副本，仍与原点相等。返回不一致的操作数
+size_t checkComplexSet(size_t steps, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_real_distribution<double> small(-10.0, 10.0), large(-8e6, 8e6);
+    vector<Complex> pool;
+    for (int i = 0; i < 2000; ++i) pool.emplace_back(small(gen), small(gen));
+    for (int i = 0; i < 2000; ++i) pool.emplace_back(large(gen), large(gen));
+    auto pick = [&] { return pool[gen() % pool.size()]; };
+    auto nudge = [&](const Complex& c) {
+        if (gen() % 4 == 0) return c;
+        return Complex(nextafter(c.real, gen() % 2 ? HUGE_VAL : -HUGE_VAL),
+                       nextafter(c.imag, gen() % 2 ? HUGE_VAL : -HUGE_VAL));
+    };
+    auto byKey = [](const Complex& a, const Complex& b) {
+        double ma = a.modulus(), mb = b.modulus();
+        if (ma != mb) return ma < mb;
+        return a.real != b.real ? a.real < b.real : a.imag < b.imag;
+    };
+
+    vector<Complex> model;
+    for (int i = 0; i < 2000; ++i) model.push_back(pick());
+    ComplexSet set(model);
+    size_t mismatches = 0;
+    for (size_t step = 0; step < steps; ++step) {
+        unsigned op = gen() % 100;
+        if (op < 25) {
+            Complex c = pick();
+            set.insert(c);
+            model.push_back(c);
+        } else if (op < 27) {
+            vector<Complex> batch(1 + gen() % 32);
+            for (auto& c : batch) c = pick();
+            set.insertBulk(batch);
+            model.insert(model.end(), batch.begin(), batch.end());
+        } else if (op < 62) {
+            Complex c = nudge(!model.empty() && gen() % 5 ? model[gen() % model.size()] : pick());
+            mismatches += set.remove(c) != removeComplex(model, c);
+        } else if (op < 82) {
+            Complex c = nudge(pick());
+            mismatches += set.contains(c) != findComplex(model, c);
+        } else if (op < 99) {
+            double m1 = pick().modulus(), m2 = m1 + (m1 < 20 ? 0.5 : 5e5) * (gen() % 1000) / 1000.0;
+            ComplexRange r = set.range(m1, m2);
+            vector<Complex> got(r.begin(), r.end()), want;
+            for (const auto& c : model) {
+                double m = c.modulus();
+                if (m >= m1 && m < m2) want.push_back(c);
+            }
+            bool ordered = is_sorted(got.begin(), got.end(), [](const Complex& a, const Complex& b) {
+                return a.modulus() != b.modulus() ? a.modulus() < b.modulus() : a.real < b.real;
+            });
+            sort(got.begin(), got.end(), byKey);
+            sort(want.begin(), want.end(), byKey);
+            bool same = got.size() == want.size() && r.size() == want.size();
+            for (size_t i = 0; same && i < got.size(); ++i) same = got[i].real == want[i].real && got[i].imag == want[i].imag;
+            mismatches += !(ordered && same);
+        } else {
+            set.flush();
+        }
+        if (set.size() != model.size()) {
+            ++mismatches;
+            break;
+        }
+    }
+    // 最后用每个候选点的四个 1 ulp 邻点逐一核对查找
+    for (const auto& p : pool) {
+        for (int k = 0; k < 4; ++k) {
+            Complex c(nextafter(p.real, k & 1 ? HUGE_VAL : -HUGE_VAL), nextafter(p.imag, k & 2 ? HUGE_VAL : -HUGE_VAL));
+            mismatches += set.contains(c) != findComplex(model, c);
+        }
+    }
+    return mismatches;
+}
+
+// 区间查询延迟：100 万个点，其中 10% 逐个插入（留在日志中的部分未归并）、1% 删除（留下删除标记），
+// 每次计时执行一批宽 0.01 的区间查询并遍历结果；对照为原有的有序 vector 逐个扫描。
+// 另测 90% 区间查询 + 10% 插入 / 删除的混合负载
+void testComplexSetRange(BenchReport& report, const BenchConfig& cfg) {
+    const size_t n = 1 << 20, queries = 1000, scanQueries = 10;
+    cout << "\n=== 有序集合区间查询 (n = " << n << ") ===\n";
+    size_t first = report.results().size();
+
+    vector<Complex> all = generateRandomComplexVector(n, 606);
+    ComplexSet base(vector<Complex>(all.begin(), all.begin() + n / 10 * 9));
+    for (size_t i = n / 10 * 9; i < n; ++i) base.insert(all[i]);
+    for (size_t i = 0; i < n / 100; ++i) base.remove(all[i * 97 % n]);
+    ComplexRange live = base.range(0, HUGE_VAL);
+    vector<Complex> sortedVec(live.begin(), live.end());
+
+    mt19937 gen(cfg.seed);
+    uniform_real_distribution<double> lo(0.0, 14.0);
+    vector<double> starts(queries);
+    for (auto& m : starts) m = lo(gen);
+
+    double sink = 0;
+    BenchResult setRange = runBenchmark("set-range", "random", n, cfg, [] {}, [&] {
+        for (double m : starts) {
+            for (const Complex& c : base.range(m, m + 0.01)) sink += c.real;
+        }
+    });
+    BenchResult scan = runBenchmark("vector-range", "random", n, cfg, [] {}, [&] {
+        for (size_t q = 0; q < scanQueries; ++q) {
+            for (const Complex& c : rangeFind(sortedVec, starts[q], starts[q] + 0.01)) sink += c.real;
+        }
+    });
+    ComplexSet work;
+    BenchResult mixed = runBenchmark("set-mix-90/10", "random", n, cfg, [&] { work = base; }, [&] {
+        for (size_t q = 0; q < queries; ++q) {
+            if (q % 10 != 9) {
+                for (const Complex& c : work.range(starts[q], starts[q] + 0.01)) sink += c.real;
+            } else if (q % 20 == 9) {
+                work.insert(Complex(starts[q], -starts[q]));
+            } else {
+                work.remove(all[q * 7919 % n]);
+            }
+        }
+    });
+    doNotOptimize(sink);
+    report.add(setRange);
+    report.add(scan);
+    report.add(mixed);
+    report.printTable(cout, first);
+    printf("每次区间查询 (%s): 有序集合 %.4f, 有序 vector 扫描 %.4f, 混合负载每次操作 %.4f\n", setRange.unit.c_str(),
+           setRange.median / queries, scan.median / scanQueries, mixed.median / queries);
+}
+
+// 列式存储（SoA）：实部、虚部分别放在 32 字节对齐的连续数组中，便于 SIMD 批量计算模长
+template <class T, size_t Align = 32>
+struct AlignedAllocator {
+    typedef T value_type;
+    template <class U> struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+    AlignedAllocator() {}
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        // 多申请 Align 字节，对齐后在首地址前一格记录原始指针
+        char* raw = static_cast<char*>(::operator new(n * sizeof(T) + Align + sizeof(void*)));
+        uintptr_t p = reinterpret_cast<uintptr_t>(raw + sizeof(void*));
+        p = (p + Align - 1) & ~uintptr_t(Align - 1);
+        reinterpret_cast<void**>(p)[-1] = raw;
+        return reinterpret_cast<T*>(p);
+    }
+    void deallocate(T* p, size_t) {
+        if (p) ::operator delete(reinterpret_cast<void**>(p)[-1]);
+    }
+    bool operator==(const AlignedAllocator&) const { return true; }
+    bool operator!=(const AlignedAllocator&) const { return false; }
+};
+
+class ComplexColumn {
+public:
+    typedef vector<double, AlignedAllocator<double> > Lane;
+    Lane re, im;
+
+    ComplexColumn() {}
+    explicit ComplexColumn(const vector<Complex>& vec) {
+        reserve(vec.size());
+        for (const auto& c : vec) push_back(c);
+    }
+
+    size_t size() const { return re.size(); }
+    bool empty() const { return re.empty(); }
+    void reserve(size_t n) { re.reserve(n); im.reserve(n); }
+    void push_back(const Complex& c) { re.push_back(c.real); im.push_back(c.imag); }
+    Complex operator[](size_t i) const { return Complex(re[i], im[i]); }
+
+    vector<Complex> toVector() const {
+        vector<Complex> vec;
+        vec.reserve(size());
+        for (size_t i = 0; i < size(); ++i) vec.emplace_back(re[i], im[i]);
+        return vec;
+    }
+};
+
+// 批量计算 |z|^2 = re^2 + im^2
+void squaredModulusBatch(const double* re, const double* im, double* out, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__AVX__)
+    for (; i + 4 <= n; i += 4) {
+        __m256d r = _mm256_loadu_pd(re + i);
+        __m256d m = _mm256_loadu_pd(im + i);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(r, r), _mm256_mul_pd(m, m)));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) {
+        __m128d r = _mm_loadu_pd(re + i);
+        __m128d m = _mm_loadu_pd(im + i);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(r, r), _mm_mul_pd(m, m)));
+    }
+#endif
+    for (; i < n; ++i) out[i] = re[i] * re[i] + im[i] * im[i];
+}
+
+// 批量计算模长 |z|，结果与 Complex::modulus() 逐位一致（sqrt 为正确舍入）
+void modulusBatch(const double* re, const double* im, double* out, size_t n) {
+    squaredModulusBatch(re, im, out, n);
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__AVX__)
+    for (; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(out + i)));
+#elif defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) _mm_storeu_pd(out + i, _mm_sqrt_pd(_mm_loadu_pd(out + i)));
+#endif
+    for (; i < n; ++i) out[i] = sqrt(out[i]);
+}
+
+// 按下标数组重排列数据
+static ComplexColumn gatherColumn(const ComplexColumn& col, const vector<size_t>& idx) {
+    ComplexColumn result;
+    result.re.resize(idx.size());
+    result.im.resize(idx.size());
+    for (size_t k = 0; k < idx.size(); ++k) {
+        result.re[k] = col.re[idx[k]];
+        result.im[k] = col.im[idx[k]];
+    }
+    return result;
+}
+
+// 与 compareComplex 相同的顺序：模长只计算一次，再对下标做稳定排序
+void sort(ComplexColumn& col) {
+    size_t n = col.size();
+    ComplexColumn::Lane mod(n);
+    modulusBatch(col.re.data(), col.im.data(), mod.data(), n);
+
+    vector<size_t> idx(n);
+    for (size_t i = 0; i < n; ++i) idx[i] = i;
+    stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+        if (abs(mod[a] - mod[b]) < 1e-9) {
+            return col.re[a] < col.re[b];
+        }
+        return mod[a] < mod[b];
+    });
+    col = gatherColumn(col, idx);
+}
 
-    auto sortedVec = baseVec;
-    sort(sortedVec.begin(), sortedVec.end(), compareComplex);
+bool findComplex(const ComplexColumn& col, const Complex& target) {
+    const double eps = 1e-9;
+    const double* re = col.re.data();
+    const double* im = col.im.data();
+    size_t n = col.size(), i = 0;
+#if defined(__AVX2__) || defined(__AVX__)
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7fffffffffffffffLL));
+    const __m256d vEps = _mm256_set1_pd(eps);
+    const __m256d tr = _mm256_set1_pd(target.real), ti = _mm256_set1_pd(target.imag);
+    for (; i + 4 <= n; i += 4) {
+        __m256d dr = _mm256_and_pd(_mm256_sub_pd(_mm256_loadu_pd(re + i), tr), absMask);
+        __m256d di = _mm256_and_pd(_mm256_sub_pd(_mm256_loadu_pd(im + i), ti), absMask);
+        __m256d hit = _mm256_and_pd(_mm256_cmp_pd(dr, vEps, _CMP_LT_OQ), _mm256_cmp_pd(di, vEps, _CMP_LT_OQ));
+        if (_mm256_movemask_pd(hit)) return true;
+    }
+#elif defined(__SSE2__)
+    const __m128d absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    const __m128d vEps = _mm_set1_pd(eps);
+    const __m128d tr = _mm_set1_pd(target.real), ti = _mm_set1_pd(target.imag);
+    for (; i + 2 <= n; i += 2) {
+        __m128d dr = _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(re + i), tr), absMask);
+        __m128d di = _mm_and_pd(_mm_sub_pd(_mm_loadu_pd(im + i), ti), absMask);
+        if (_mm_movemask_pd(_mm_and_pd(_mm_cmplt_pd(dr, vEps), _mm_cmplt_pd(di, vEps)))) return true;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (abs(re[i] - target.real) < eps && abs(im[i] - target.imag) < eps) return true;
+    }
+    return false;
+}
 
-    auto reversedVec = sortedVec;
-    reverse(reversedVec.begin(), reversedVec.end());
+ComplexColumn uniqueComplex(const ComplexColumn& col) {
+    vector<size_t> idx(col.size());
+    for (size_t i = 0; i < idx.size(); ++i) idx[i] = i;
+    sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+        if (abs(col.re[a] - col.re[b]) < 1e-9)
+            return col.im[a] < col.im[b];
+        return col.re[a] < col.re[b];
+    });
+    auto last = unique(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+        return col[a] == col[b];
+    });
+    idx.erase(last, idx.end());
+    return gatherColumn(col, idx);
+}
 
-    auto shuffledVec = baseVec;
-    random_shuffle(shuffledVec.begin(), shuffledVec.end());
+// 以 |z|^2 与 m1^2、m2^2 比较，避免逐元素开方；
+// 仅当 |z|^2 落在边界附近（相对误差 1e-12 内）时回退到 sqrt，保证与 vector 版本结果一致
+ComplexColumn rangeFind(const ComplexColumn& sortedCol, double m1, double m2) {
+    ComplexColumn result;
+    if (m2 <= 0 || m1 >= m2) return result;
+
+    const double tol = 1e-12;
+    const double lo2 = m1 > 0 ? m1 * m1 : -1.0, hi2 = m2 * m2;
+    const double loIn = lo2 * (1 + tol), loOut = lo2 * (1 - tol);
+    const double hiIn = hi2 * (1 - tol), hiOut = hi2 * (1 + tol);
+
+    const size_t BLOCK = 1024;
+    alignas(32) double sq[BLOCK];
+    size_t n = sortedCol.size();
+    for (size_t base = 0; base < n; base += BLOCK) {
+        size_t len = min(BLOCK, n - base);
+        squaredModulusBatch(sortedCol.re.data() + base, sortedCol.im.data() + base, sq, len);
+        for (size_t k = 0; k < len; ++k) {
+            double s = sq[k];
+            if (s < loOut || s >= hiOut) continue;
+            if (s < loIn || s >= hiIn) {
+                double mod = sqrt(s);
+                if (!(mod >= m1 && mod < m2)) continue;
+            }
+            result.re.push_back(sortedCol.re[base + k]);
+            result.im.push_back(sortedCol.im[base + k]);
+        }
+    }
+    return result;
+}
 
-    auto testSort = [&](const vector<Complex>& input, const string& name, void (*sortFunc)(vector<Complex>&)) {
-        auto vec = input;
-        clock_t start = clock();
-        sortFunc(vec);
-        clock_t end = clock();
-        double time = double(end - start) / CLOCKS_PER_SEC * 1000.0;
-        cout << name << ": " << fixed << setprecision(2) << time << " ms\n";
+// 排序性能测试：规模扫描 × 五种输入分布，O(n^2) 的冒泡排序只测到 1000
+void testSortingPerformance(BenchReport& report, const BenchConfig& cfg) {
+    cout << "\n=== 排序性能测试 ===\n";
+    size_t first = report.results().size();
+
+    vector<Complex> scratch;  // 自底向上归并的缓冲区在生成输入时按规模分配，不计入计时
+    vector<SortCase<Complex> > cases = {
+        {"bubble", bubbleSort, 1000},
+        {"merge", mergeSort, size_t(-1)},
+        {"merge-bottomup", [&scratch](vector<Complex>& v) { mergeSortBottomUp(v, scratch); }, size_t(-1)},
+        {"keyed", keyedSort, size_t(-1)},
+        {"radix", radixSort, size_t(-1)},
     };
+    benchmarkSorts(report, cfg, geometricSizes(1000, 100000, 10), [&scratch](size_t n) {
+        scratch.resize(n);
+        auto vec = generateRandomComplexVector(n, 2025);
+        keyedSort(vec);
+        return vec;
+    }, cases);
+
+    report.printTable(cout, first);
+}
+
+static bool sameComplexSequence(const vector<Complex>& a, const vector<Complex>& b) {
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin(), [](const Complex& x, const Complex& y) {
+        return x.real == y.real && x.imag == y.imag;
+    });
+}
+
+// 并行归并排序与 stable_sort 对拍：规模含奇数和不足一个插入排序段的情况，粒度小到 1，线程数 1~3；
+// 一半元素取自小整数网格，有大量比较相等的元素（如 (3,4) 与 (3,-4)），逐元素比较同时检查稳定性。
+// 返回不一致的组数
+size_t checkParallelMergeSort() {
+    mt19937 gen(55);
+    uniform_real_distribution<double> dis(-10.0, 10.0);
+    const size_t sizes[] = {0, 1, 2, 3, 31, 33, 1000, 4097, 65537};
+    const size_t grains[] = {1, 3, 64, 1 << 14};
+    size_t mismatches = 0;
+    for (unsigned t = 1; t <= 3; ++t) {
+        WorkStealingPool pool(t);
+        for (size_t n : sizes) {
+            vector<Complex> input(n);
+            for (auto& c : input) {
+                c = gen() % 2 ? Complex(int(gen() % 7) - 3, int(gen() % 9) - 4) : Complex(dis(gen), dis(gen));
+            }
+            vector<Complex> expected = input;
+            stable_sort(expected.begin(), expected.end(), compareComplex);
+            for (size_t grain : grains) {
+                vector<Complex> got = input;
+                parallelMergeSort(got, pool, grain);
+                mismatches += !sameComplexSequence(got, expected);
+            }
+        }
+    }
+    return mismatches;
+}
 
-    cout << "冒泡排序:\n";
-    testSort(sortedVec, "  顺序", bubbleSort);
-    testSort(reversedVec, "  逆序", bubbleSort);
-    testSort(shuffledVec, "  乱序", bubbleSort);
+// 并行归并排序加速比：以单线程自底向上归并的中位数为基准，线程数按 2 的幂增长并以硬件并发数收尾；
+// 每种线程数最后一次排序的结果都与 stable_sort 核对
+void testParallelSortScaling(BenchReport& report, const BenchConfig& cfg,
+                             const vector<Complex>& baseVec, size_t grain = 1 << 14) {
+    cout << "\n=== 并行归并排序加速比 (n = " << baseVec.size() << ", grain = " << grain << ") ===\n";
+    cout << "  与 stable_sort 对拍 (各种规模 / 粒度 / 线程数): " << checkParallelMergeSort() << " 组不一致\n";
 
-    cout << "归并排序:\n";
-    testSort(sortedVec, "  顺序", mergeSort);
-    testSort(reversedVec, "  逆序", mergeSort);
-    testSort(shuffledVec, "  乱序", mergeSort);
+    vector<Complex> expected = baseVec;
+    stable_sort(expected.begin(), expected.end(), compareComplex);
+    vector<Complex> vec;
+    auto reset = [&] { vec = baseVec; };
+    BenchResult base = runBenchmark("merge-bottomup", "random", baseVec.size(), cfg, reset,
+                                    [&] { mergeSortBottomUp(vec); });
+    report.add(base);
+    cout << "  顺序基准: " << fixed << setprecision(2) << base.median << " " << base.unit << "\n";
+
+    for (unsigned t : scalingThreadCounts()) {
+        WorkStealingPool pool(t);
+        BenchResult r = runBenchmark("parallel-t" + to_string(t), "random", baseVec.size(), cfg, reset,
+                                     [&] { parallelMergeSort(vec, pool, grain); });
+        report.add(r);
+        cout << "  " << t << " 线程: " << r.median << " " << r.unit << ", 加速比 " << base.median / r.median
+             << (sameComplexSequence(vec, expected) ? "" : ", 结果不一致!") << "\n";
+    }
 }
 
 // work2.cpp 表达式计算相关实现
 #define MAX_EXPR_LEN 100
-#define MAX_STACK_SIZE 100
+#define STACK_INLINE_SIZE 32
 #define N_OPTR 14
 
-typedef enum {
-    ADD, SUB, MUL, DIV, POW, FAC, L_P, R_P, EOE, SIN, COS, TAN, LOG, LN
-} Operator;
+typedef enum {
+    ADD, SUB, MUL, DIV, POW, FAC, L_P, R_P, EOE, SIN, COS, TAN, LOG, LN
+} Operator;
+
+// 求值状态：出错时不再 printf + exit，而是返回状态码，由调用者决定如何处理
+typedef enum {
+    EVAL_OK = 0,
+    EVAL_ERR_TOKEN,       // 无效的字符或函数名
+    EVAL_ERR_SYNTAX,      // 括号不匹配、缺少操作数等
+    EVAL_ERR_DIV_ZERO,    // 除数为 0
+    EVAL_ERR_FACTORIAL,   // 阶乘参数不是非负整数
+    EVAL_ERR_LOG_DOMAIN,  // 对数参数不大于 0
+    EVAL_ERR_NO_MEMORY,   // 栈扩容失败
+    EVAL_ERR_OVERFLOW,    // 结果超出可表示范围（如 171! 超出 double）
+    EVAL_ERR_INEXACT      // 精确模式下出现无法精确表示的运算
+} EvalStatus;
+
+const char *evalStatusMessage(EvalStatus status) {
+    switch (status) {
+        case EVAL_OK:             return "成功";
+        case EVAL_ERR_TOKEN:      return "无效的字符或函数名";
+        case EVAL_ERR_SYNTAX:     return "表达式语法错误";
+        case EVAL_ERR_DIV_ZERO:   return "除数不能为0";
+        case EVAL_ERR_FACTORIAL:  return "阶乘仅适用于非负整数";
+        case EVAL_ERR_LOG_DOMAIN: return "对数的参数必须大于0";
+        case EVAL_ERR_NO_MEMORY:  return "内存不足";
+        case EVAL_ERR_OVERFLOW:   return "结果超出可表示范围";
+        case EVAL_ERR_INEXACT:    return "精确模式只支持整数运算";
+    }
+    return "未知错误";
+}
+
+typedef struct {
+    Operator op;
+    int pos;  // 运算符在表达式中的位置，用于报告出错位置
+} OptrItem;
+
+// 两个栈先使用内嵌的 STACK_INLINE_SIZE 个元素，放不下时才转到堆上按 2 倍扩容，
+// 常见的嵌套深度下不做任何堆分配，也不再有固定的深度上限。
+// data 可能指向结构体自身的 inlineData，因此栈不能按值拷贝。
+typedef struct {
+    double inlineData[STACK_INLINE_SIZE];
+    double *data;
+    int top;
+    int capacity;
+} OpndStack;
+
+typedef struct {
+    OptrItem inlineData[STACK_INLINE_SIZE];
+    OptrItem *data;
+    int top;
+    int capacity;
+} OptrStack;
+
+void initOpndStack(OpndStack *s) {
+    s->data = s->inlineData;
+    s->top = -1;
+    s->capacity = STACK_INLINE_SIZE;
+}
+
+void initOptrStack(OptrStack *s) {
+    s->data = s->inlineData;
+    s->top = -1;
+    s->capacity = STACK_INLINE_SIZE;
+}
+
+void freeOpndStack(OpndStack *s) {
+    if (s->data != s->inlineData) free(s->data);
+    initOpndStack(s);
+}
+
+void freeOptrStack(OptrStack *s) {
+    if (s->data != s->inlineData) free(s->data);
+    initOptrStack(s);
+}
+
+int isOpndEmpty(const OpndStack *s) {
+    return s->top == -1;
+}
+
+int isOptrEmpty(const OptrStack *s) {
+    return s->top == -1;
+}
+
+// 容量翻倍；第一次扩容时把内嵌缓冲区的内容搬到堆上。失败时返回 0，原内容不变
+template <typename T>
+static int growStack(T **data, T *inlineData, int *capacity) {
+    int newCapacity = *capacity * 2;
+    T *grown;
+    if (*data == inlineData) {
+        grown = (T *)malloc(sizeof(T) * newCapacity);
+        if (grown) memcpy(grown, inlineData, sizeof(T) * *capacity);
+    } else {
+        grown = (T *)realloc(*data, sizeof(T) * newCapacity);
+    }
+    if (!grown) return 0;
+    *data = grown;
+    *capacity = newCapacity;
+    return 1;
+}
+
+int pushOpnd(OpndStack *s, double val) {
+    if (s->top == s->capacity - 1 && !growStack(&s->data, s->inlineData, &s->capacity)) {
+        return 0;
+    }
+    s->data[++(s->top)] = val;
+    return 1;
+}
+
+int pushOptr(OptrStack *s, Operator op, int pos) {
+    if (s->top == s->capacity - 1 && !growStack(&s->data, s->inlineData, &s->capacity)) {
+        return 0;
+    }
+    OptrItem item = {op, pos};
+    s->data[++(s->top)] = item;
+    return 1;
+}
+
+int popOpnd(OpndStack *s, double *val) {
+    if (isOpndEmpty(s)) return 0;
+    *val = s->data[(s->top)--];
+    return 1;
+}
+
+int popOptr(OptrStack *s, OptrItem *item) {
+    if (isOptrEmpty(s)) return 0;
+    *item = s->data[(s->top)--];
+    return 1;
+}
+
+int getTopOpnd(const OpndStack *s, double *val) {
+    if (isOpndEmpty(s)) return 0;
+    *val = s->data[s->top];
+    return 1;
+}
+
+// 栈底始终压着 EOE，解析过程中运算符栈不会为空；万一为空也按 EOE 处理
+Operator getTopOptr(const OptrStack *s) {
+    return isOptrEmpty(s) ? EOE : s->data[s->top].op;
+}
+
+const char pri[N_OPTR][N_OPTR] = {
+    /*          +    -    *    /    ^    !    (    )    \0   SIN  COS  TAN  LOG  LN */
+    /* + */   '>', '>', '<', '<', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
+    /* - */   '>', '>', '<', '<', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
+    /* * */   '>', '>', '>', '>', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
+    /* / */   '>', '>', '>', '>', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
+    /* ^ */   '>', '>', '>', '>', '>', '<', '<', '>', '>', '>', '>', '>', '>', '>',
+    /* ! */   '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
+    /* ( */   '<', '<', '<', '<', '<', '<', '<', '=', ' ', '<', '<', '<', '<', '<',
+    /* ) */   ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+    /* \0*/   '<', '<', '<', '<', '<', '<', '<', ' ', '=', '<', '<', '<', '<', '<',
+    /* SIN*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
+    /* COS*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
+    /* TAN*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
+    /* LOG*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
+    /* LN */  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>'
+};
+
+static inline int isSpaceChar(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+int skipSpaces(const char *expr, int pos) {
+    while (isSpaceChar(expr[pos])) pos++;
+    return pos;
+}
+
+// 10^0 ~ 10^22 都能用 double 精确表示
+static const double exactPow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 一遍扫描解析 digits[.digits][(e|E)[+-]digits]，返回消耗的字符数，s 不以数字开头时返回 0。
+// 有效数字全部装进 64 位整数 m 且 m <= 2^53、十进制指数在 [-22, 22] 内时，
+// m 与 10^|e| 都是精确的，一次乘或除即为正确舍入的结果（Clinger 快速路径）；
+// 其余少见情况把同一段文本交给 strtod，结果同样正确舍入。
+int parseNumber(const char *s, double *out) {
+    const char *p = s;
+    uint64_t mant = 0;
+    int digits = 0, exp10 = 0, truncated = 0;
+    if (*p < '0' || *p > '9') return 0;
+
+    for (; *p >= '0' && *p <= '9'; p++) {
+        if (digits < 19) {
+            mant = mant * 10 + (*p - '0');
+            if (mant) digits++;
+        } else {
+            exp10++;
+            if (*p != '0') truncated = 1;
+        }
+    }
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            if (digits < 19) {
+                mant = mant * 10 + (*p - '0');
+                if (mant) digits++;
+                exp10--;
+            } else if (*p != '0') {
+                truncated = 1;
+            }
+        }
+    }
+    // 只有后面确实跟着指数数字时才把 e 当作科学计数法
+    if (*p == 'e' || *p == 'E') {
+        const char *q = p + 1;
+        int negative = 0, e = 0;
+        if (*q == '+' || *q == '-') negative = *q++ == '-';
+        if (*q >= '0' && *q <= '9') {
+            for (; *q >= '0' && *q <= '9'; q++) {
+                if (e < 100000) e = e * 10 + (*q - '0');
+            }
+            exp10 += negative ? -e : e;
+            p = q;
+        }
+    }
+
+    int len = int(p - s);
+    if (!truncated && mant <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        *out = exp10 < 0 ? double(mant) / exactPow10[-exp10] : double(mant) * exactPow10[exp10];
+    } else {
+        char local[64];
+        string heap;
+        const char *text = local;
+        if (len < (int)sizeof(local)) {
+            memcpy(local, s, len);
+            local[len] = '\0';
+        } else {
+            heap.assign(s, len);
+            text = heap.c_str();
+        }
+        *out = strtod(text, nullptr);
+    }
+    return len;
+}
+
+// 函数名的完美哈希：前两个字符 (c0 * 4 + c1) & 7 对五个函数名两两不同，
+// 一次查表得到唯一候选，再比较剩余字符。与原实现一样按前缀匹配（"sinx" 为 sin x）
+typedef struct {
+    const char *name;
+    int len;
+    Operator op;
+} FunctionName;
+
+static const FunctionName functionTable[8] = {
+    {nullptr, 0, EOE}, {"tan", 3, TAN}, {nullptr, 0, EOE}, {"cos", 3, COS},
+    {nullptr, 0, EOE}, {"sin", 3, SIN}, {"ln", 2, LN},     {"log", 3, LOG}
+};
+
+// 返回匹配的函数名长度，不是函数名时返回 0
+int matchFunction(const char *s, Operator *op) {
+    if (s[0] == '\0') return 0;
+    const FunctionName &f = functionTable[((unsigned char)s[0] * 4 + (unsigned char)s[1]) & 7];
+    if (!f.name || strncmp(s, f.name, f.len) != 0) return 0;
+    *op = f.op;
+    return f.len;
+}
+
+// 返回 1 表示数字，0 表示运算符，-1 表示无效记号（不输出信息，由调用者报告）。
+// 记号之前的空白字符被跳过
+int getNextToken(const char *expr, int *pos, double *num, Operator *op) {
+    int p = skipSpaces(expr, *pos);
+    char c = expr[p];
+    if (c == '\0') {
+        *pos = p;
+        *op = EOE;
+        return 0;
+    }
+    if (c >= '0' && c <= '9') {
+        *pos = p + parseNumber(expr + p, num);
+        return 1;
+    }
+
+    int len = 1;
+    switch (c) {
+        case '+': *op = ADD; break;
+        case '-': *op = SUB; break;
+        case '*': *op = MUL; break;
+        case '/': *op = DIV; break;
+        case '^': *op = POW; break;
+        case '!': *op = FAC; break;
+        case '(': *op = L_P; break;
+        case ')': *op = R_P; break;
+        default:
+            len = matchFunction(expr + p, op);
+            if (len == 0) {
+                *pos = p + 1;
+                return -1;
+            }
+    }
+    *pos = p + len;
+    return 0;
+}
+
+// 阶乘表：0! ~ 170! 在编译期算好（170! 是 double 能表示的最大阶乘），求值时只需查表。
+// 按 1*1*2*3*... 的顺序相乘，与原来逐次相乘的舍入结果完全一致。
+#define MAX_DOUBLE_FACTORIAL 170
+
+constexpr double factorialProduct(double acc, int i, int n) {
+    return i > n ? acc : factorialProduct(acc * i, i + 1, n);
+}
+
+template <int... I> struct IndexList {};
+template <int N, int... I> struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndexList<0, I...> { typedef IndexList<I...> type; };
+
+template <typename List> struct FactorialTable;
+template <int... I> struct FactorialTable<IndexList<I...> > {
+    static constexpr double values[sizeof...(I)] = {factorialProduct(1, 1, I)...};
+};
+template <int... I> constexpr double FactorialTable<IndexList<I...> >::values[sizeof...(I)];
+
+typedef FactorialTable<MakeIndexList<MAX_DOUBLE_FACTORIAL + 1>::type> Factorials;
+static_assert(Factorials::values[10] == 3628800.0, "factorial table");
+
+// ln(n!)：表内的 n 直接取对数，更大的 n 用 lgamma(n + 1)，不会溢出
+double logFactorial(double n) {
+    return n <= MAX_DOUBLE_FACTORIAL ? log(Factorials::values[(int)n]) : lgamma(n + 1);
+}
+
+// a^b：|b| 不超过 POW_INT_LIMIT 的整数指数用平方求幂（至多 2*log2|b| 次乘法），不调用 pow。
+// 舍入误差随乘法次数累积，限制在 16 以内时实测相对误差不超过约 7 ulp；
+// b = 2 时恰为 a*a，与 OP_SQUARE 一致。其余情况调用 pow
+#define POW_INT_LIMIT 16
+
+static inline double powerOf(double a, double b) {
+    if (b >= -POW_INT_LIMIT && b <= POW_INT_LIMIT && b == (int)b) {
+        int e = (int)b;
+        unsigned k = e < 0 ? -e : e;
+        double r = 1, x = a;
+        // 固定 5 轮、查表选择乘数，指数随机变化时也没有难以预测的分支；
+        // 乘 1.0 是精确的，结果与逐位判断相同
+        for (int bit = 0; bit < 5; ++bit) {
+            const double factor[2] = {1.0, x};
+            r *= factor[k & 1];
+            x *= x;
+            k >>= 1;
+        }
+        const double result[2] = {r, 1 / r};
+        return result[e < 0];
+    }
+    return pow(a, b);
+}
+
+// 纯函数形式的运算；一元运算只使用 a。定义域错误时返回对应的状态码
+EvalStatus applyOperator(Operator op, double a, double b, double *result) {
+    switch (op) {
+        case ADD: *result = a + b; break;
+        case SUB: *result = a - b; break;
+        case MUL: *result = a * b; break;
+        case DIV:
+            if (b == 0) return EVAL_ERR_DIV_ZERO;
+            *result = a / b;
+            break;
+        case POW: *result = powerOf(a, b); break;
+        case FAC:
+            if (a < 0 || a != floor(a)) return EVAL_ERR_FACTORIAL;
+            if (a > MAX_DOUBLE_FACTORIAL) return EVAL_ERR_OVERFLOW;
+            *result = Factorials::values[(int)a];
+            break;
+        case SIN: *result = sin(a); break;
+        case COS: *result = cos(a); break;
+        case TAN: *result = tan(a); break;
+        case LOG:
+            if (a <= 0) return EVAL_ERR_LOG_DOMAIN;
+            *result = log10(a);
+            break;
+        case LN:
+            if (a <= 0) return EVAL_ERR_LOG_DOMAIN;
+            *result = log(a);
+            break;
+        default:
+            return EVAL_ERR_SYNTAX;
+    }
+    return EVAL_OK;
+}
+
+int operatorArity(Operator op) {
+    switch (op) {
+        case ADD: case SUB: case MUL: case DIV: case POW:
+            return 2;
+        case FAC: case SIN: case COS: case TAN: case LOG: case LN:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// 从操作数栈弹出 op 所需的操作数并计算；操作数不足视为语法错误
+EvalStatus calculate(Operator op, OpndStack *opndStack, double *result) {
+    double a, b = 0;
+    int arity = operatorArity(op);
+    if (arity == 0) return EVAL_ERR_SYNTAX;
+    if (arity == 2 && !popOpnd(opndStack, &b)) return EVAL_ERR_SYNTAX;
+    if (!popOpnd(opndStack, &a)) return EVAL_ERR_SYNTAX;
+    return applyOperator(op, a, b, result);
+}
+
+char priority(Operator op1, Operator op2) {
+    return pri[op1][op2];
+}
+
+// 跳过空白后，两个操作数之间必须有运算符："2 3"、"2 3 +"、"2(3)" 都是语法错误。
+// 操作数以数字、变量、'(' 或函数名开头，以数字、变量、')' 或后缀 '!' 结尾
+static inline int startsOperand(Operator op) {
+    return op == L_P || op >= SIN;
+}
+
+static inline int endsOperand(Operator op) {
+    return op == R_P || op == FAC;
+}
+
+// 求值上下文：持有两个栈和最近一次的错误信息，不含任何全局状态，
+// 每个线程各用一个即可并发求值；反复求值时复用已扩容的栈缓冲区。
+typedef struct {
+    OpndStack opnd;
+    OptrStack optr;
+    EvalStatus status;
+    int errorPos;  // 出错的字符下标，成功时为 -1
+} EvalContext;
+
+void initEvalContext(EvalContext *ctx) {
+    initOpndStack(&ctx->opnd);
+    initOptrStack(&ctx->optr);
+    ctx->status = EVAL_OK;
+    ctx->errorPos = -1;
+}
+
+void freeEvalContext(EvalContext *ctx) {
+    freeOpndStack(&ctx->opnd);
+    freeOptrStack(&ctx->optr);
+}
+
+static EvalStatus evalFail(EvalContext *ctx, EvalStatus status, int pos) {
+    ctx->status = status;
+    ctx->errorPos = pos;
+    return status;
+}
+
+EvalStatus evaluateExpressionCtx(EvalContext *ctx, const char *expr, double *result) {
+    double num, value;
+    Operator op;
+    OptrItem topItem;
+    int pos = 0, tokenPos;
+    int tokenResult;
+    int afterOperand = 0;  // 上一个记号结束了一个操作数
+    EvalStatus status;
+
+    ctx->opnd.top = -1;
+    ctx->optr.top = -1;
+    ctx->status = EVAL_OK;
+    ctx->errorPos = -1;
+
+    if (!pushOptr(&ctx->optr, EOE, 0)) return evalFail(ctx, EVAL_ERR_NO_MEMORY, 0);
+
+    while (1) {
+        pos = skipSpaces(expr, pos);
+        tokenPos = pos;
+        tokenResult = getNextToken(expr, &pos, &num, &op);
+        if (tokenResult == -1) {
+            return evalFail(ctx, EVAL_ERR_TOKEN, tokenPos);
+        }
+
+        if (tokenResult == 1) {
+            if (afterOperand) return evalFail(ctx, EVAL_ERR_SYNTAX, tokenPos);
+            if (!pushOpnd(&ctx->opnd, num)) return evalFail(ctx, EVAL_ERR_NO_MEMORY, tokenPos);
+            afterOperand = 1;
+        } else {
+            if (afterOperand && startsOperand(op)) return evalFail(ctx, EVAL_ERR_SYNTAX, tokenPos);
+            afterOperand = endsOperand(op);
+            while (priority(getTopOptr(&ctx->optr), op) == '>') {
+                if (!popOptr(&ctx->optr, &topItem)) return evalFail(ctx, EVAL_ERR_SYNTAX, tokenPos);
+                status = calculate(topItem.op, &ctx->opnd, &value);
+                if (status != EVAL_OK) return evalFail(ctx, status, topItem.pos);
+                pushOpnd(&ctx->opnd, value);  // 刚弹出过操作数，不会扩容
+            }
+
+            char p = priority(getTopOptr(&ctx->optr), op);
+            if (p == '<') {
+                if (!pushOptr(&ctx->optr, op, tokenPos)) return evalFail(ctx, EVAL_ERR_NO_MEMORY, tokenPos);
+            } else if (p == '=') {
+                popOptr(&ctx->optr, &topItem);
+                if (op != R_P) {
+                    pushOptr(&ctx->optr, op, tokenPos);
+                }
+            } else {
+                return evalFail(ctx, EVAL_ERR_SYNTAX, tokenPos);
+            }
+
+            if (op == EOE && getTopOptr(&ctx->optr) == EOE) {
+                break;
+            }
+        }
+    }
+
+    // 恰好剩一个操作数
+    if (ctx->opnd.top != 0 || !getTopOpnd(&ctx->opnd, result)) return evalFail(ctx, EVAL_ERR_SYNTAX, pos);
+    return EVAL_OK;
+}
+
+// 兼容原接口：成功返回 1，失败返回 0
+int evaluateExpression(const char *expr, double *result) {
+    EvalContext ctx;
+    initEvalContext(&ctx);
+    EvalStatus status = evaluateExpressionCtx(&ctx, expr, result);
+    freeEvalContext(&ctx);
+    return status == EVAL_OK;
+}
+
+// 编译求值：表达式只解析一次，沿用上面的优先级表把运算按执行顺序输出为后缀（RPN）字节码，
+// 之后每次求值只需在一个扁平的操作数栈上顺序执行指令。
+// 编译时做常量折叠：运算的操作数都是常量时直接算出结果，只保留一条 OP_PUSH。
+// 表达式中可以引用变量（x、y、speed_1 ...），编译后按首次出现的顺序编号，求值时按编号绑定。
+#define OP_PUSH N_OPTR
+#define OP_VAR (N_OPTR + 1)
+#define OP_SQUARE (N_OPTR + 2)  // x^2 改写为 x*x：一次正确舍入，且便于向量化
+#define EVAL_INLINE_STACK 64
+
+typedef struct {
+    int code;      // Operator，或 OP_PUSH / OP_VAR
+    int slot;      // OP_VAR 的变量编号
+    double value;  // OP_PUSH 压入的常量
+} Instr;
+
+typedef struct {
+    vector<Instr> code;
+    vector<string> vars;  // 变量名，下标即编号
+    int maxDepth;         // 执行时操作数栈的最大深度
+} CompiledExpr;
+
+// 输出一条运算指令；depth 为编译期模拟的栈深度
+static int emitOperator(CompiledExpr *prog, Operator op, int *depth, int foldConstants) {
+    int arity = operatorArity(op);
+    if (arity == 0 || *depth < arity) return 0;
+
+    vector<Instr>& code = prog->code;
+    size_t n = code.size();
+    if (foldConstants && n >= (size_t)arity && code[n - 1].code == OP_PUSH &&
+        (arity == 1 || code[n - 2].code == OP_PUSH)) {
+        double a = arity == 2 ? code[n - 2].value : code[n - 1].value;
+        double b = arity == 2 ? code[n - 1].value : 0;
+        double folded;
+        // 会出错的运算不折叠，留到运行时报告
+        if (applyOperator(op, a, b, &folded) == EVAL_OK) {
+            code.resize(n - arity);
+            Instr push = {OP_PUSH, 0, folded};
+            code.push_back(push);
+            *depth -= arity - 1;
+            return 1;
+        }
+    }
+    if (op == POW && code[n - 1].code == OP_PUSH && code[n - 1].value == 2.0) {
+        code[n - 1].code = OP_SQUARE;
+        *depth -= 1;
+        return 1;
+    }
+    Instr ins = {op, 0, 0};
+    code.push_back(ins);
+    *depth -= arity - 1;
+    return 1;
+}
+
+// 变量名：字母或下划线开头，后接字母、数字、下划线。
+// 以函数名 sin/cos/tan/log/ln 开头的仍按函数处理（与 getNextToken 一致，如 "sinx" 即 sin x）
+static int scanVariable(const char *expr, int *pos, string *name) {
+    const char *p = expr + *pos;
+    Operator func;
+    if (!isalpha((unsigned char)*p) && *p != '_') return 0;
+    if (matchFunction(p, &func)) return 0;
+    int len = 0;
+    while (isalnum((unsigned char)p[len]) || p[len] == '_') len++;
+    name->assign(p, len);
+    *pos += len;
+    return 1;
+}
+
+// 与 evalFail 相同：记下出错位置并返回状态码
+static EvalStatus compileFail(int *errorPos, EvalStatus status, int pos) {
+    *errorPos = pos;
+    return status;
+}
+
+static EvalStatus compileWithStack(const char *expr, CompiledExpr *prog, int foldConstants, OptrStack *optrStack,
+                                   int *errorPos) {
+    double num;
+    Operator op;
+    OptrItem topItem;
+    int pos = 0, tokenPos;
+    int depth = 0;
+    int tokenResult;
+    int afterOperand = 0;  // 上一个记号结束了一个操作数
+
+    string name;
+
+    prog->code.clear();
+    prog->vars.clear();
+    prog->maxDepth = 0;
+    *errorPos = -1;
+    if (!pushOptr(optrStack, EOE, 0)) return compileFail(errorPos, EVAL_ERR_NO_MEMORY, 0);
+
+    while (1) {
+        pos = skipSpaces(expr, pos);
+        tokenPos = pos;
+        if (scanVariable(expr, &pos, &name)) {
+            if (afterOperand) return compileFail(errorPos, EVAL_ERR_SYNTAX, tokenPos);
+            afterOperand = 1;
+            int slot = int(find(prog->vars.begin(), prog->vars.end(), name) - prog->vars.begin());
+            if (slot == (int)prog->vars.size()) prog->vars.push_back(name);
+            Instr load = {OP_VAR, slot, 0};
+            prog->code.push_back(load);
+            if (++depth > prog->maxDepth) prog->maxDepth = depth;
+            continue;
+        }
+
+        tokenResult = getNextToken(expr, &pos, &num, &op);
+        if (tokenResult == -1) {
+            return compileFail(errorPos, EVAL_ERR_TOKEN, tokenPos);
+        }
+
+        if (tokenResult == 1) {
+            if (afterOperand) return compileFail(errorPos, EVAL_ERR_SYNTAX, tokenPos);
+            afterOperand = 1;
+            Instr push = {OP_PUSH, 0, num};
+            prog->code.push_back(push);
+            if (++depth > prog->maxDepth) prog->maxDepth = depth;
+        } else {
+            if (afterOperand && startsOperand(op)) return compileFail(errorPos, EVAL_ERR_SYNTAX, tokenPos);
+            afterOperand = endsOperand(op);
+            while (priority(getTopOptr(optrStack), op) == '>') {
+                if (!popOptr(optrStack, &topItem)) return compileFail(errorPos, EVAL_ERR_SYNTAX, tokenPos);
+                // 操作数不足（如 "x+"）：与解释器一样报在该运算符处
+                if (!emitOperator(prog, topItem.op, &depth, foldConstants)) {
+                    return compileFail(errorPos, EVAL_ERR_SYNTAX, topItem.pos);
+                }
+            }
+
+            if (priority(getTopOptr(optrStack), op) == '<') {
+                if (!pushOptr(optrStack, op, tokenPos)) return compileFail(errorPos, EVAL_ERR_NO_MEMORY, tokenPos);
+            } else if (priority(getTopOptr(optrStack), op) == '=') {
+                popOptr(optrStack, &topItem);
+                if (op != R_P) {
+                    pushOptr(optrStack, op, tokenPos);
+                }
+            } else {
+                return compileFail(errorPos, EVAL_ERR_SYNTAX, tokenPos);
+            }
+
+            if (op == EOE && getTopOptr(optrStack) == EOE) {
+                break;
+            }
+        }
+    }
+
+    // 恰好剩一个值：多出的操作数（如 "2x"）说明表达式缺少运算符
+    if (depth != 1) return compileFail(errorPos, EVAL_ERR_SYNTAX, pos);
+    return EVAL_OK;
+}
+
+// 成功返回 1；失败返回 0，并可通过 status / errorPos 取得错误类型和源码位置
+int compileExpression(const char *expr, CompiledExpr *prog, int foldConstants = 1,
+                      EvalStatus *status = nullptr, int *errorPos = nullptr) {
+    OptrStack optrStack;
+    initOptrStack(&optrStack);
+    int pos;
+    EvalStatus st = compileWithStack(expr, prog, foldConstants, &optrStack, &pos);
+    freeOptrStack(&optrStack);
+    if (status) *status = st;
+    if (errorPos) *errorPos = pos;
+    return st == EVAL_OK;
+}
+
+// 在调用者提供的栈上执行字节码，st 至少要有 prog->maxDepth 个元素；
+// 出错时返回对应的状态码（字节码不保留源码位置，因此不报告出错位置）
+EvalStatus runCompiled(const CompiledExpr *prog, double *st, double *result, const double *vars) {
+    if (!prog->vars.empty() && !vars) return EVAL_ERR_SYNTAX;
+    int top = -1;
+    const Instr *ip = prog->code.data();
+    const Instr *end = ip + prog->code.size();
+    EvalStatus status;
+    for (; ip != end; ++ip) {
+        switch (ip->code) {
+            case OP_PUSH: st[++top] = ip->value; break;
+            case OP_VAR: st[++top] = vars[ip->slot]; break;
+            case ADD: st[top - 1] += st[top]; --top; break;
+            case SUB: st[top - 1] -= st[top]; --top; break;
+            case MUL: st[top - 1] *= st[top]; --top; break;
+            case DIV:
+                if (st[top] == 0) return EVAL_ERR_DIV_ZERO;
+                st[top - 1] /= st[top];
+                --top;
+                break;
+            case POW: st[top - 1] = powerOf(st[top - 1], st[top]); --top; break;
+            case OP_SQUARE: st[top] *= st[top]; break;
+            default:
+                status = applyOperator((Operator)ip->code, st[top], 0, &st[top]);
+                if (status != EVAL_OK) return status;
+                break;
+        }
+    }
+    if (top < 0) return EVAL_ERR_SYNTAX;
+    // 与 evaluateExpression 一致，结果取栈顶
+    *result = st[top];
+    return EVAL_OK;
+}
+
+// vars[i] 为变量 prog->vars[i] 的取值；没有变量时可传 nullptr
+int evalCompiled(const CompiledExpr *prog, double *result, const double *vars = nullptr) {
+    double inlineStack[EVAL_INLINE_STACK];
+    vector<double> heapStack;
+    double *st = inlineStack;
+    if (prog->maxDepth > EVAL_INLINE_STACK) {
+        heapStack.resize(prog->maxDepth);
+        st = heapStack.data();
+    }
+    return runCompiled(prog, st, result, vars) == EVAL_OK;
+}
+
+// 任意精度整数：符号位 + 以 10^9 为基的小端序数组，只实现精确模式需要的运算。
+// 乘法为教科书算法，结果位数由 EXACT_MAX_DIGITS 限制，不会失控。
+#define EXACT_MAX_DIGITS 100000
+
+class BigInt {
+public:
+    BigInt() : negative(false) {}
+
+    explicit BigInt(long long v) : negative(v < 0) {
+        unsigned long long m = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+        while (m) {
+            limbs.push_back(uint32_t(m % BASE));
+            m /= BASE;
+        }
+    }
+
+    bool isZero() const { return limbs.empty(); }
+    bool isNegative() const { return negative; }
+
+    // log10|x| 的近似值（取最高两个数组元素），x 为 0 时返回 0
+    double log10Magnitude() const {
+        if (limbs.empty()) return 0;
+        double top = limbs.back() + (limbs.size() > 1 ? limbs[limbs.size() - 2] / double(BASE) : 0);
+        return log10(top) + 9.0 * (limbs.size() - 1);
+    }
+
+    // 绝对值不超过 limit 时写入 *out 并返回 true
+    bool toInt64(long long limit, long long *out) const {
+        if (limbs.size() > 2) return false;
+        unsigned long long m = 0;
+        for (size_t i = limbs.size(); i-- > 0;) m = m * BASE + limbs[i];
+        if (m > (unsigned long long)limit) return false;
+        *out = negative ? -(long long)m : (long long)m;
+        return true;
+    }
+
+    string toString() const {
+        if (limbs.empty()) return "0";
+        string s = negative ? "-" : "";
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u", limbs.back());
+        s += buf;
+        for (size_t i = limbs.size() - 1; i-- > 0;) {
+            snprintf(buf, sizeof(buf), "%09u", limbs[i]);
+            s += buf;
+        }
+        return s;
+    }
+
+    // *this *= m，要求 m < 10^9
+    void mulSmall(uint32_t m) {
+        uint64_t carry = 0;
+        for (uint32_t &limb : limbs) {
+            uint64_t cur = uint64_t(limb) * m + carry;
+            limb = uint32_t(cur % BASE);
+            carry = cur / BASE;
+        }
+        if (carry) limbs.push_back(uint32_t(carry));
+        trim();
+    }
+
+    // *this /= d，返回余数的绝对值，要求 0 < d < 10^9
+    uint32_t divSmall(uint32_t d) {
+        uint64_t rem = 0;
+        for (size_t i = limbs.size(); i-- > 0;) {
+            uint64_t cur = limbs[i] + rem * BASE;
+            limbs[i] = uint32_t(cur / d);
+            rem = cur % d;
+        }
+        trim();
+        return uint32_t(rem);
+    }
+
+    // 截断除法 a = q*b + r，|r| < |b| 且 r 与 a 同号，b 不能为 0。
+    // 从高位起逐个 10^9 位试商，每位二分查找商，适合精确模式下中等规模的整除
+    static void divMod(const BigInt &a, const BigInt &b, BigInt *q, BigInt *r) {
+        BigInt divisor = b, rem, quot, t;
+        divisor.negative = false;
+        quot.limbs.assign(a.limbs.size(), 0);
+        for (size_t i = a.limbs.size(); i-- > 0;) {
+            rem.limbs.insert(rem.limbs.begin(), a.limbs[i]);  // rem = rem * BASE + a[i]
+            rem.trim();
+            uint32_t lo = 0, hi = BASE - 1;
+            if (compareMagnitude(rem, divisor) < 0) continue;
+            while (lo < hi) {
+                uint32_t mid = lo + (hi - lo + 1) / 2;
+                t = divisor;
+                t.mulSmall(mid);
+                if (compareMagnitude(t, rem) <= 0) lo = mid;
+                else hi = mid - 1;
+            }
+            t = divisor;
+            t.mulSmall(lo);
+            rem = subMagnitude(rem, t, false);
+            quot.limbs[i] = lo;
+        }
+        quot.negative = a.negative != b.negative;
+        quot.trim();
+        rem.negative = a.negative;
+        rem.trim();
+        *q = quot;
+        *r = rem;
+    }
+
+    friend BigInt operator+(const BigInt &a, const BigInt &b) {
+        if (a.negative == b.negative) return addMagnitude(a, b, a.negative);
+        if (compareMagnitude(a, b) >= 0) return subMagnitude(a, b, a.negative);
+        return subMagnitude(b, a, b.negative);
+    }
+
+    friend BigInt operator-(const BigInt &a, const BigInt &b) {
+        BigInt nb = b;
+        if (!nb.isZero()) nb.negative = !nb.negative;
+        return a + nb;
+    }
+
+    friend BigInt operator*(const BigInt &a, const BigInt &b) {
+        BigInt r;
+        if (a.isZero() || b.isZero()) return r;
+        vector<uint64_t> acc(a.limbs.size() + b.limbs.size() + 1, 0);
+        for (size_t i = 0; i < a.limbs.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.limbs.size(); ++j) {
+                uint64_t cur = acc[i + j] + uint64_t(a.limbs[i]) * b.limbs[j] + carry;
+                acc[i + j] = cur % BASE;
+                carry = cur / BASE;
+            }
+            for (size_t k = i + b.limbs.size(); carry; ++k) {
+                uint64_t cur = acc[k] + carry;
+                acc[k] = cur % BASE;
+                carry = cur / BASE;
+            }
+        }
+        r.limbs.assign(acc.begin(), acc.end());
+        r.negative = a.negative != b.negative;
+        r.trim();
+        return r;
+    }
+
+private:
+    static const uint32_t BASE = 1000000000;
+    vector<uint32_t> limbs;
+    bool negative;
+
+    void trim() {
+        while (!limbs.empty() && limbs.back() == 0) limbs.pop_back();
+        if (limbs.empty()) negative = false;
+    }
+
+    static int compareMagnitude(const BigInt &a, const BigInt &b) {
+        if (a.limbs.size() != b.limbs.size()) return a.limbs.size() < b.limbs.size() ? -1 : 1;
+        for (size_t i = a.limbs.size(); i-- > 0;) {
+            if (a.limbs[i] != b.limbs[i]) return a.limbs[i] < b.limbs[i] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static BigInt addMagnitude(const BigInt &a, const BigInt &b, bool negative) {
+        BigInt r;
+        size_t n = max(a.limbs.size(), b.limbs.size());
+        uint32_t carry = 0;
+        for (size_t i = 0; i < n || carry; ++i) {
+            uint32_t cur = carry + (i < a.limbs.size() ? a.limbs[i] : 0) + (i < b.limbs.size() ? b.limbs[i] : 0);
+            carry = cur >= BASE;
+            r.limbs.push_back(carry ? cur - BASE : cur);
+        }
+        r.negative = negative;
+        r.trim();
+        return r;
+    }
+
+    // 要求 |a| >= |b|
+    static BigInt subMagnitude(const BigInt &a, const BigInt &b, bool negative) {
+        BigInt r = a;
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < r.limbs.size(); ++i) {
+            uint32_t sub = borrow + (i < b.limbs.size() ? b.limbs[i] : 0);
+            borrow = r.limbs[i] < sub;
+            r.limbs[i] = borrow ? r.limbs[i] + BASE - sub : r.limbs[i] - sub;
+        }
+        r.negative = negative;
+        r.trim();
+        return r;
+    }
+};
+
+// n!：把相邻的因子先乘成不超过 10^9 的小数再乘入，乘法次数约减半
+BigInt bigFactorial(unsigned n) {
+    BigInt r(1);
+    uint64_t m = 1;
+    for (unsigned i = 2; i <= n; ++i) {
+        if (m * i >= 1000000000) {
+            r.mulSmall(uint32_t(m));
+            m = 1;
+        }
+        m *= i;
+    }
+    r.mulSmall(uint32_t(m));
+    return r;
+}
+
+// base^e，平方求幂
+BigInt bigPower(BigInt base, unsigned e) {
+    BigInt r(1);
+    while (e) {
+        if (e & 1) r = r * base;
+        e >>= 1;
+        if (e) base = base * base;
+    }
+    return r;
+}
+
+// 精确模式：在字节码上用 BigInt 求值，结果以十进制字符串返回。
+// 编译时不做常量折叠，避免常量先被舍入成 double。
+// 支持整数的 + - * ^ !，以及能整除的 /（如 52!/(5!*47!)）；
+// 小数、三角/对数函数、负指数等无法精确表示的运算返回 EVAL_ERR_INEXACT，
+// 结果预计超过 EXACT_MAX_DIGITS 位时返回 EVAL_ERR_OVERFLOW。
+EvalStatus evaluateExpressionExact(const char *expr, string *result) {
+    CompiledExpr prog;
+    if (!compileExpression(expr, &prog, 0)) {
+        EvalContext ctx;
+        double ignored;
+        initEvalContext(&ctx);
+        EvalStatus status = evaluateExpressionCtx(&ctx, expr, &ignored);
+        freeEvalContext(&ctx);
+        return status == EVAL_OK ? EVAL_ERR_SYNTAX : status;
+    }
+    if (!prog.vars.empty()) return EVAL_ERR_TOKEN;
+
+    vector<BigInt> st;
+    st.reserve(prog.maxDepth);
+    for (const Instr &ins : prog.code) {
+        if (ins.code == OP_PUSH) {
+            // 2^53 以内的整数字面量可由 double 精确还原
+            if (ins.value != floor(ins.value) || fabs(ins.value) > 9007199254740992.0) return EVAL_ERR_INEXACT;
+            st.push_back(BigInt((long long)ins.value));
+            continue;
+        }
+        BigInt b = st.back();
+        if (ins.code == OP_SQUARE) {
+            if (b.log10Magnitude() * 2 > EXACT_MAX_DIGITS) return EVAL_ERR_OVERFLOW;
+            st.back() = b * b;
+            continue;
+        }
+        if (operatorArity((Operator)ins.code) == 1) {
+            long long n;
+            if (ins.code != FAC) return EVAL_ERR_INEXACT;
+            if (b.isNegative() || !b.toInt64(1000000000, &n)) return EVAL_ERR_FACTORIAL;
+            if (logFactorial(double(n)) / log(10.0) > EXACT_MAX_DIGITS) return EVAL_ERR_OVERFLOW;
+            st.back() = bigFactorial(unsigned(n));
+            continue;
+        }
+        st.pop_back();
+        BigInt &a = st.back();
+        switch (ins.code) {
+            case ADD: a = a + b; break;
+            case SUB: a = a - b; break;
+            case MUL:
+                if (a.log10Magnitude() + b.log10Magnitude() > EXACT_MAX_DIGITS) return EVAL_ERR_OVERFLOW;
+                a = a * b;
+                break;
+            case DIV: {
+                long long d;
+                if (b.isZero()) return EVAL_ERR_DIV_ZERO;
+                if (b.toInt64(999999999, &d)) {
+                    bool negate = d < 0;
+                    if (a.divSmall(uint32_t(negate ? -d : d)) != 0) return EVAL_ERR_INEXACT;
+                    if (negate) a = BigInt(0) - a;
+                } else {
+                    BigInt q, r;
+                    BigInt::divMod(a, b, &q, &r);
+                    if (!r.isZero()) return EVAL_ERR_INEXACT;
+                    a = q;
+                }
+                break;
+            }
+            case POW: {
+                long long e;
+                if (b.isNegative() || !b.toInt64(1000000000, &e)) return EVAL_ERR_INEXACT;
+                if (a.log10Magnitude() * e > EXACT_MAX_DIGITS) return EVAL_ERR_OVERFLOW;
+                a = bigPower(a, unsigned(e));
+                break;
+            }
+            default:
+                return EVAL_ERR_SYNTAX;
+        }
+    }
+    if (st.empty()) return EVAL_ERR_SYNTAX;
+    *result = st.back().toString();
+    return EVAL_OK;
+}
+
+// 批量求值：columns[i] 指向变量 prog->vars[i] 的数据列，对 rows 行逐行计算，结果写入 out。
+// 按 EVAL_BLOCK 行一块执行：每条指令对整块数据做一次循环，指令分派的开销被整块摊薄；
+// 四则运算和整数指数的乘方用 AVX/SSE2 跨行向量化。sin/cos/tan/log/ln 没有向量化：仍对每个元素
+// 调用 libm，只省去逐行的指令分派；换成多项式近似会与 evalCompiled 的结果不再逐位一致。
+// 逐行结果与 evalCompiled 完全一致。
+// 出错的行（除数为 0、对数参数非正、阶乘参数非法）结果为 NaN，rowOk 不为空时对应位置写 0；返回出错行数。
+#define EVAL_BLOCK 256
+
+// 整数指数的 a^b：与 powerOf 相同的固定 5 轮平方求幂，各通道的乘法序列与标量版本一样，结果逐位一致。
+// 一组中有任一通道的指数不是 |b| <= POW_INT_LIMIT 的整数时，这一组逐个调用 powerOf
+static void batchPow(double *a, const double *b, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__) || defined(__AVX__)
+    const __m256d one = _mm256_set1_pd(1.0), limit = _mm256_set1_pd(POW_INT_LIMIT), sign = _mm256_set1_pd(-0.0);
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i), y = _mm256_loadu_pd(b + i);
+        __m128i e = _mm256_cvttpd_epi32(y);
+        __m256d ok = _mm256_and_pd(_mm256_cmp_pd(_mm256_cvtepi32_pd(e), y, _CMP_EQ_OQ),
+                                   _mm256_cmp_pd(_mm256_andnot_pd(sign, y), limit, _CMP_LE_OQ));
+        if (_mm256_movemask_pd(ok) != 0xF) {
+            for (size_t k = i; k < i + 4; ++k) a[k] = powerOf(a[k], b[k]);
+            continue;
+        }
+        __m128i s = _mm_srai_epi32(e, 31), k = _mm_sub_epi32(_mm_xor_si128(e, s), s);  // |e|
+        __m256d r = one;
+        for (int bit = 0; bit < 5; ++bit) {
+            __m128i m = _mm_cmpeq_epi32(_mm_and_si128(k, _mm_set1_epi32(1)), _mm_set1_epi32(1));
+            __m256d odd = _mm256_castsi256_pd(_mm256_insertf128_si256(
+                _mm256_castsi128_si256(_mm_unpacklo_epi32(m, m)), _mm_unpackhi_epi32(m, m), 1));
+            r = _mm256_mul_pd(r, _mm256_blendv_pd(one, x, odd));
+            x = _mm256_mul_pd(x, x);
+            k = _mm_srli_epi32(k, 1);
+        }
+        __m256d neg = _mm256_cmp_pd(y, _mm256_setzero_pd(), _CMP_LT_OQ);
+        _mm256_storeu_pd(a + i, _mm256_blendv_pd(r, _mm256_div_pd(one, r), neg));
+    }
+#elif defined(__SSE2__)
+    const __m128d one = _mm_set1_pd(1.0), limit = _mm_set1_pd(POW_INT_LIMIT), sign = _mm_set1_pd(-0.0);
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i), y = _mm_loadu_pd(b + i);
+        __m128i e = _mm_cvttpd_epi32(y);
+        __m128d ok = _mm_and_pd(_mm_cmpeq_pd(_mm_cvtepi32_pd(e), y), _mm_cmple_pd(_mm_andnot_pd(sign, y), limit));
+        if (_mm_movemask_pd(ok) != 0x3) {
+            a[i] = powerOf(a[i], b[i]);
+            a[i + 1] = powerOf(a[i + 1], b[i + 1]);
+            continue;
+        }
+        __m128i s = _mm_srai_epi32(e, 31), k = _mm_sub_epi32(_mm_xor_si128(e, s), s);  // |e|
+        __m128d r = one;
+        for (int bit = 0; bit < 5; ++bit) {
+            __m128i m = _mm_cmpeq_epi32(_mm_and_si128(k, _mm_set1_epi32(1)), _mm_set1_epi32(1));
+            __m128d odd = _mm_castsi128_pd(_mm_unpacklo_epi32(m, m));
+            r = _mm_mul_pd(r, _mm_or_pd(_mm_and_pd(odd, x), _mm_andnot_pd(odd, one)));
+            x = _mm_mul_pd(x, x);
+            k = _mm_srli_epi32(k, 1);
+        }
+        __m128d neg = _mm_cmplt_pd(y, _mm_setzero_pd());
+        _mm_storeu_pd(a + i, _mm_or_pd(_mm_and_pd(neg, _mm_div_pd(one, r)), _mm_andnot_pd(neg, r)));
+    }
+#endif
+    for (; i < n; ++i) a[i] = powerOf(a[i], b[i]);
+}
+
+static void batchBinary(int op, double *a, const double *b, size_t n, unsigned char *err) {
+    size_t i = 0;
+    if (op == POW) {
+        batchPow(a, b, n);
+        return;
+    }
+    if (op == DIV) {
+        for (size_t k = 0; k < n; ++k) {
+            if (b[k] == 0) err[k] = 1;
+        }
+    }
+#if defined(__AVX2__) || defined(__AVX__)
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i), y = _mm256_loadu_pd(b + i);
+        switch (op) {
+            case ADD: x = _mm256_add_pd(x, y); break;
+            case SUB: x = _mm256_sub_pd(x, y); break;
+            case MUL: x = _mm256_mul_pd(x, y); break;
+            default: x = _mm256_div_pd(x, y); break;
+        }
+        _mm256_storeu_pd(a + i, x);
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) {
+        __m128d x = _mm_loadu_pd(a + i), y = _mm_loadu_pd(b + i);
+        switch (op) {
+            case ADD: x = _mm_add_pd(x, y); break;
+            case SUB: x = _mm_sub_pd(x, y); break;
+            case MUL: x = _mm_mul_pd(x, y); break;
+            default: x = _mm_div_pd(x, y); break;
+        }
+        _mm_storeu_pd(a + i, x);
+    }
+#endif
+    for (; i < n; ++i) {
+        switch (op) {
+            case ADD: a[i] += b[i]; break;
+            case SUB: a[i] -= b[i]; break;
+            case MUL: a[i] *= b[i]; break;
+            default: a[i] /= b[i]; break;
+        }
+    }
+}
+
+static void batchUnary(int op, double *a, size_t n, unsigned char *err) {
+    switch (op) {
+        case SIN: for (size_t i = 0; i < n; ++i) a[i] = sin(a[i]); break;
+        case COS: for (size_t i = 0; i < n; ++i) a[i] = cos(a[i]); break;
+        case TAN: for (size_t i = 0; i < n; ++i) a[i] = tan(a[i]); break;
+        case LOG:
+            for (size_t i = 0; i < n; ++i) {
+                if (a[i] <= 0) err[i] = 1;
+                a[i] = log10(a[i]);
+            }
+            break;
+        case LN:
+            for (size_t i = 0; i < n; ++i) {
+                if (a[i] <= 0) err[i] = 1;
+                a[i] = log(a[i]);
+            }
+            break;
+        default:
+            for (size_t i = 0; i < n; ++i) {
+                if (applyOperator((Operator)op, a[i], 0, &a[i]) != EVAL_OK) err[i] = 1;
+            }
+            break;
+    }
+}
+
+size_t evalBatch(const CompiledExpr *prog, const double *const *columns, size_t rows,
+                 double *out, unsigned char *rowOk = nullptr) {
+    size_t depth = prog->maxDepth > 0 ? prog->maxDepth : 1;
+    vector<double> stack(depth * EVAL_BLOCK);
+    unsigned char err[EVAL_BLOCK];
+    size_t failed = 0;
+
+    for (size_t base = 0; base < rows; base += EVAL_BLOCK) {
+        size_t n = min(size_t(EVAL_BLOCK), rows - base);
+        memset(err, 0, n);
+        int top = -1;
+        for (const Instr &ins : prog->code) {
+            double *dst = &stack[(top + 1) * EVAL_BLOCK];
+            switch (ins.code) {
+                case OP_PUSH:
+                    fill(dst, dst + n, ins.value);
+                    ++top;
+                    break;
+                case OP_VAR:
+                    memcpy(dst, columns[ins.slot] + base, n * sizeof(double));
+                    ++top;
+                    break;
+                case ADD: case SUB: case MUL: case DIV: case POW:
+                    batchBinary(ins.code, &stack[(top - 1) * EVAL_BLOCK], &stack[top * EVAL_BLOCK], n, err);
+                    --top;
+                    break;
+                case OP_SQUARE:
+                    batchBinary(MUL, &stack[top * EVAL_BLOCK], &stack[top * EVAL_BLOCK], n, err);
+                    break;
+                default:
+                    batchUnary(ins.code, &stack[top * EVAL_BLOCK], n, err);
+                    break;
+            }
+        }
+
+        const double *res = &stack[top * EVAL_BLOCK];
+        for (size_t i = 0; i < n; ++i) {
+            out[base + i] = err[i] ? NAN : res[i];
+            if (rowOk) rowOk[base + i] = !err[i];
+            failed += err[i];
+        }
+    }
+    return failed;
+}
+
+// 按变量名绑定数据列；缺少任一变量时返回 0
+int bindColumns(const CompiledExpr *prog, const map<string, const double *> &named,
+                vector<const double *> *columns) {
+    columns->clear();
+    for (const string &v : prog->vars) {
+        auto it = named.find(v);
+        if (it == named.end()) return 0;
+        columns->push_back(it->second);
+    }
+    return 1;
+}
+
+// 表达式求值服务：可被多个线程同时调用。
+// 编译缓存把表达式文本映射到编译结果，按文本哈希分成 EVAL_CACHE_SHARDS 个分片，
+// 每个分片一把锁、各自维护一条 LRU 链表，不同分片的查找互不阻塞；
+// 编译在锁外进行，被淘汰的条目由 shared_ptr 保证仍在使用它的线程可以安全读完。
+// 批量请求按 EVAL_TASK_CHUNK 条一块交给固定的工作线程池，每个线程复用自己的求值栈。
+#define EVAL_CACHE_SHARDS 16
+#define EVAL_TASK_CHUNK 64
+
+typedef struct {
+    string expr;
+    vector<double> vars;  // 按变量在表达式中首次出现的顺序给出
+} EvalRequest;
+
+typedef struct {
+    double value;
+    EvalStatus status;
+    int errorPos;  // 仅编译失败时有效，否则为 -1
+} EvalResponse;
+
+typedef struct {
+    uint64_t requests;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t failures;
+    uint64_t evictions;
+    uint64_t compileNs;  // 编译耗时之和
+    uint64_t evalNs;     // 各线程执行字节码的耗时之和（不含查缓存和编译）
+    size_t cached;
+} EvalServiceStats;
+
+class EvalService {
+public:
+    // threads 为工作线程数（0 表示硬件并发数）；cacheCapacity 为缓存条目总数
+    explicit EvalService(unsigned threads = 0, size_t cacheCapacity = 4096)
+        : pool(threads), shardCapacity(max(size_t(1), cacheCapacity / EVAL_CACHE_SHARDS)),
+          requests(0), hits(0), misses(0), failures(0), evictions(0), compileNs(0), evalNs(0) {}
+
+    EvalResponse evaluate(const string &expr, const double *vars = nullptr, size_t nvars = 0) {
+        EvalResponse resp;
+        evaluateOne(expr, vars, nvars, &resp);
+        return resp;
+    }
+
+    void evaluateBatch(const vector<EvalRequest> &reqs, vector<EvalResponse> &out) {
+        out.resize(reqs.size());
+        TaskGroup group(pool);
+        for (size_t begin = 0; begin < reqs.size(); begin += EVAL_TASK_CHUNK) {
+            size_t end = min(reqs.size(), begin + EVAL_TASK_CHUNK);
+            group.run([this, &reqs, &out, begin, end] {
+                for (size_t i = begin; i < end; ++i) {
+                    const EvalRequest &r = reqs[i];
+                    evaluateOne(r.expr, r.vars.data(), r.vars.size(), &out[i]);
+                }
+            });
+        }
+        group.wait();
+    }
+
+    EvalServiceStats stats() {
+        EvalServiceStats s;
+        s.requests = requests.load();
+        s.hits = hits.load();
+        s.misses = misses.load();
+        s.failures = failures.load();
+        s.evictions = evictions.load();
+        s.compileNs = compileNs.load();
+        s.evalNs = evalNs.load();
+        s.cached = 0;
+        for (Shard &shard : shards) {
+            lock_guard<mutex> lock(shard.mutex);
+            s.cached += shard.lru.size();
+        }
+        return s;
+    }
+
+    unsigned threads() const { return pool.size(); }
+
+private:
+    // 编译失败的表达式也缓存（ok = 0），重复的坏请求不必反复编译
+    struct Formula {
+        CompiledExpr prog;
+        int ok;
+        EvalStatus status;
+        int errorPos;
+    };
+    typedef list<pair<string, shared_ptr<const Formula> > > LruList;
+
+    struct Shard {
+        std::mutex mutex;
+        LruList lru;  // 队首为最近使用
+        unordered_map<string, LruList::iterator> index;
+    };
+
+    // 每个线程（工作线程以及帮忙执行任务的调用线程）各自的求值栈和诊断用上下文
+    struct Scratch {
+        vector<double> stack;
+        EvalContext ctx;
+        Scratch() : stack(EVAL_INLINE_STACK) { initEvalContext(&ctx); }
+        ~Scratch() { freeEvalContext(&ctx); }
+    };
+
+    WorkStealingPool pool;
+    Shard shards[EVAL_CACHE_SHARDS];
+    size_t shardCapacity;
+    atomic<uint64_t> requests, hits, misses, failures, evictions, compileNs, evalNs;
+
+    static Scratch &scratch() {
+        static thread_local Scratch s;
+        return s;
+    }
+
+    static uint64_t elapsedNs(chrono::steady_clock::time_point start) {
+        return uint64_t(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    }
 
-typedef struct {
-    double data[MAX_STACK_SIZE];
-    int top;
-} OpndStack;
+    shared_ptr<const Formula> lookup(const string &expr) {
+        Shard &shard = shards[hash<string>()(expr) % EVAL_CACHE_SHARDS];
+        {
+            lock_guard<mutex> lock(shard.mutex);
+            auto it = shard.index.find(expr);
+            if (it != shard.index.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                hits.fetch_add(1);
+                return it->second->second;
+            }
+        }
+        misses.fetch_add(1);
+
+        auto start = chrono::steady_clock::now();
+        shared_ptr<Formula> f = make_shared<Formula>();
+        f->ok = compileExpression(expr.c_str(), &f->prog, 1, &f->status, &f->errorPos);
+        compileNs.fetch_add(elapsedNs(start));
+
+        lock_guard<mutex> lock(shard.mutex);
+        auto it = shard.index.find(expr);
+        if (it != shard.index.end()) {
+            // 其他线程已抢先编译了同一表达式，使用已缓存的版本
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return it->second->second;
+        }
+        shard.lru.push_front(make_pair(expr, shared_ptr<const Formula>(f)));
+        shard.index[expr] = shard.lru.begin();
+        if (shard.lru.size() > shardCapacity) {
+            shard.index.erase(shard.lru.back().first);
+            shard.lru.pop_back();
+            evictions.fetch_add(1);
+        }
+        return f;
+    }
 
-typedef struct {
-    Operator data[MAX_STACK_SIZE];
-    int top;
-} OptrStack;
+    void evaluateOne(const string &expr, const double *vars, size_t nvars, EvalResponse *resp) {
+        requests.fetch_add(1);
+        shared_ptr<const Formula> f = lookup(expr);
+        resp->value = NAN;
+        resp->errorPos = -1;
+        if (!f->ok) {
+            resp->status = f->status;
+            resp->errorPos = f->errorPos;
+        } else if (nvars < f->prog.vars.size()) {
+            resp->status = EVAL_ERR_SYNTAX;
+        } else {
+            Scratch &sc = scratch();
+            if (sc.stack.size() < size_t(f->prog.maxDepth)) sc.stack.resize(f->prog.maxDepth);
+            auto start = chrono::steady_clock::now();
+            resp->status = runCompiled(&f->prog, sc.stack.data(), &resp->value, vars);
+            evalNs.fetch_add(elapsedNs(start));
+            if (resp->status != EVAL_OK) resp->value = NAN;
+        }
+        if (resp->status != EVAL_OK) failures.fetch_add(1);
+    }
+};
 
-void initOpndStack(OpndStack *s) {
-    s->top = -1;
+// 服务驱动的请求格式：每行一个表达式，可在分号后给出变量取值，如 "x*x+y; 3 4"。
+// 响应每行一个结果，或 "error: 原因 [@位置]"。
+int parseRequestLine(const string &line, EvalRequest *req) {
+    size_t semi = line.find(';');
+    req->expr.assign(line, 0, semi == string::npos ? line.size() : semi);
+    while (!req->expr.empty() && isspace((unsigned char)req->expr.back())) req->expr.pop_back();
+    req->vars.clear();
+    if (semi != string::npos) {
+        const char *p = line.c_str() + semi + 1;
+        char *end;
+        while (1) {
+            double v = strtod(p, &end);
+            if (end == p) break;
+            req->vars.push_back(v);
+            p = end;
+        }
+        while (isspace((unsigned char)*p)) p++;
+        if (*p) return 0;
+    }
+    return !req->expr.empty();
 }
 
-void initOptrStack(OptrStack *s) {
-    s->top = -1;
+void formatResponse(const EvalResponse &resp, string *out) {
+    char buf[128];
+    if (resp.status == EVAL_OK) {
+        snprintf(buf, sizeof(buf), "%.17g\n", resp.value);
+    } else if (resp.errorPos >= 0) {
+        snprintf(buf, sizeof(buf), "error: %s @%d\n", evalStatusMessage(resp.status), resp.errorPos);
+    } else {
+        snprintf(buf, sizeof(buf), "error: %s\n", evalStatusMessage(resp.status));
+    }
+    out->append(buf);
 }
 
-int isOpndEmpty(OpndStack *s) {
-    return s->top == -1;
+void printServiceStats(FILE *fp, EvalService &service) {
+    EvalServiceStats s = service.stats();
+    fprintf(fp, "requests %llu, hit rate %.2f%%, cached %zu, evictions %llu, failures %llu, "
+                "compile %.3f ms, eval %.3f ms\n",
+            (unsigned long long)s.requests, s.requests ? 100.0 * s.hits / s.requests : 0.0, s.cached,
+            (unsigned long long)s.evictions, (unsigned long long)s.failures,
+            s.compileNs / 1e6, s.evalNs / 1e6);
 }
 
-int isOptrEmpty(OptrStack *s) {
-    return s->top == -1;
+// 把若干完整的请求行作为一批求值，结果按原顺序追加到 out；"#stats" 行返回当前计数
+void serveLines(EvalService &service, const vector<string> &lines, string *out) {
+    vector<EvalRequest> reqs;
+    vector<int> kind(lines.size());  // 0 请求，1 格式错误，2 统计
+    for (size_t i = 0; i < lines.size(); ++i) {
+        EvalRequest req;
+        if (lines[i] == "#stats") {
+            kind[i] = 2;
+        } else if (parseRequestLine(lines[i], &req)) {
+            reqs.push_back(req);
+        } else {
+            kind[i] = 1;
+        }
+    }
+    vector<EvalResponse> resps;
+    service.evaluateBatch(reqs, resps);
+
+    size_t next = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (kind[i] == 0) {
+            formatResponse(resps[next++], out);
+        } else if (kind[i] == 1) {
+            out->append("error: 请求格式错误\n");
+        } else {
+            EvalServiceStats s = service.stats();
+            char buf[128];
+            snprintf(buf, sizeof(buf), "stats: requests %llu hits %llu misses %llu cached %zu\n",
+                     (unsigned long long)s.requests, (unsigned long long)s.hits,
+                     (unsigned long long)s.misses, s.cached);
+            out->append(buf);
+        }
+    }
 }
 
-void pushOpnd(OpndStack *s, double val) {
-    if (s->top < MAX_STACK_SIZE - 1) {
-        s->data[++(s->top)] = val;
-    } else {
-        printf("操作数栈溢出\n");
-        exit(1);
+// 从标准输入读请求（适合用文件或管道做压力测试），每 batch 行求值一次
+void serveStdin(EvalService &service, size_t batch) {
+    vector<string> lines;
+    string line, out;
+    while (1) {
+        bool more = static_cast<bool>(getline(cin, line));
+        if (more && !line.empty() && line.back() == '\r') line.pop_back();
+        if (more) lines.push_back(line);  // 空行也要回一行错误，保持请求与响应逐行对应
+        if (lines.size() >= batch || (!more && !lines.empty())) {
+            out.clear();
+            serveLines(service, lines, &out);
+            fwrite(out.data(), 1, out.size(), stdout);
+            fflush(stdout);
+            lines.clear();
+        }
+        if (!more) break;
     }
+    printServiceStats(stderr, service);
 }
 
-void pushOptr(OptrStack *s, Operator op) {
-    if (s->top < MAX_STACK_SIZE - 1) {
-        s->data[++(s->top)] = op;
-    } else {
-        printf("运算符栈溢出\n");
-        exit(1);
+#if defined(__unix__) || defined(__APPLE__)
+// 本地 TCP 驱动：只监听 127.0.0.1，每个连接一个线程，共享同一个服务实例。
+// 每次 recv 收到的所有完整行作为一批求值。
+static void serveConnection(EvalService &service, int fd) {
+    string pending, out;
+    vector<string> lines;
+    char buf[65536];
+    while (1) {
+        ssize_t got = recv(fd, buf, sizeof(buf), 0);
+        if (got <= 0) break;
+        pending.append(buf, size_t(got));
+        size_t start = 0, nl;
+        lines.clear();
+        while ((nl = pending.find('\n', start)) != string::npos) {
+            size_t len = nl - start;
+            if (len > 0 && pending[nl - 1] == '\r') len--;
+            lines.push_back(pending.substr(start, len));
+            start = nl + 1;
+        }
+        pending.erase(0, start);
+        if (lines.empty()) continue;
+        out.clear();
+        serveLines(service, lines, &out);
+        size_t sent = 0;
+        while (sent < out.size()) {
+            ssize_t n = send(fd, out.data() + sent, out.size() - sent, 0);
+            if (n <= 0) break;
+            sent += size_t(n);
+        }
+        if (sent < out.size()) break;
     }
+    close(fd);
 }
 
-double popOpnd(OpndStack *s) {
-    if (!isOpndEmpty(s)) {
-        return s->data[(s->top)--];
-    } else {
-        printf("操作数栈为空\n");
-        exit(1);
+int serveSocket(EvalService &service, int port) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return 1;
+    }
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, 64) < 0) {
+        perror("bind/listen");
+        close(listener);
+        return 1;
+    }
+    fprintf(stderr, "表达式服务监听 127.0.0.1:%d，工作线程 %u\n", port, service.threads());
+    while (1) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            break;
+        }
+        thread(serveConnection, ref(service), fd).detach();
     }
+    close(listener);
+    return 1;
 }
+#else
+int serveSocket(EvalService &, int) {
+    fprintf(stderr, "当前平台不支持套接字驱动，请使用 --serve 从标准输入读取\n");
+    return 1;
+}
+#endif
 
-Operator popOptr(OptrStack *s) {
-    if (!isOptrEmpty(s)) {
-        return s->data[(s->top)--];
-    } else {
-        printf("运算符栈为空\n");
-        exit(1);
+// work3.cpp 最大矩形面积相关实现
+
+// 单调栈一遍扫描：栈中下标对应的高度严格递增，遇到不高于栈顶的柱子时弹出栈顶并结算以它为高的矩形，
+// 左边界是新的栈顶、右边界是当前位置；末尾用高度 0 的哨兵清空栈。
+// 栈是调用者提供的扁平 vector，逐行调用时可反复使用；面积和宽度按 64 位计算，不会在 int 中溢出
+long long largestRectangleInHistogram(const int *heights, size_t n, vector<size_t> &st) {
+    st.clear();
+    long long maxArea = 0;
+
+    for (size_t i = 0; i <= n; ++i) {
+        int h = i < n ? heights[i] : 0;
+        while (!st.empty() && heights[st.back()] >= h) {
+            long long height = heights[st.back()];
+            st.pop_back();
+            long long left = st.empty() ? -1 : (long long)st.back();
+            maxArea = max(maxArea, height * ((long long)i - left - 1));
+        }
+        st.push_back(i);
     }
+
+    return maxArea;
 }
 
-double getTopOpnd(OpndStack *s) {
-    if (!isOpndEmpty(s)) {
-        return s->data[s->top];
-    } else {
-        printf("操作数栈为空\n");
-        exit(1);
+long long maximalRectangle(const uint64_t *bits, size_t rows, size_t cols, size_t wordsPerRow);
+
+class Solution {
+public:
+    long long largestRectangleArea(vector<int>& heights) {
+        vector<size_t> st;  // 栈深只在高度单调递增时接近 n，按需增长
+        return largestRectangleInHistogram(heights.data(), heights.size(), st);
     }
-}
 
-Operator getTopOptr(OptrStack *s) {
-    if (!isOptrEmpty(s)) {
-        return s->data[s->top];
-    } else {
-        printf("运算符栈为空\n");
-        exit(1);
+    // 全为 '1' 的最大矩形；先按行打包成位图再逐行计算
+    long long maximalRectangle(vector<vector<char> >& matrix) {
+        if (matrix.empty()) return 0;
+        size_t rows = matrix.size(), cols = matrix[0].size(), stride = (cols + 63) / 64;
+        vector<uint64_t> bits(rows * stride, 0);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                if (matrix[i][j] == '1') bits[i * stride + j / 64] |= uint64_t(1) << (j % 64);
+            }
+        }
+        return ::maximalRectangle(bits.data(), rows, cols, stride);
     }
-}
+};
 
-const char pri[N_OPTR][N_OPTR] = {
-    /*          +    -    *    /    ^    !    (    )    \0   SIN  COS  TAN  LOG  LN */
-    /* + */   '>', '>', '<', '<', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
-    /* - */   '>', '>', '<', '<', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
-    /* * */   '>', '>', '>', '>', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
-    /* / */   '>', '>', '>', '>', '<', '<', '<', '>', '>', '>', '>', '>', '>', '>',
-    /* ^ */   '>', '>', '>', '>', '>', '<', '<', '>', '>', '>', '>', '>', '>', '>',
-    /* ! */   '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
-    /* ( */   '<', '<', '<', '<', '<', '<', '<', '=', ' ', '<', '<', '<', '<', '<',
-    /* ) */   ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
-    /* \0*/   '<', '<', '<', '<', '<', '<', '<', ' ', '=', '<', '<', '<', '<', '<',
-    /* SIN*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
-    /* COS*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
-    /* TAN*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
-    /* LOG*/  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>',
-    /* LN */  '>', '>', '>', '>', '>', '>', ' ', '>', '>', '>', '>', '>', '>', '>'
+// 并行分治最大矩形。顺序单调栈在柱子 i 出栈时结算 h[i] * (R - L - 1)，
+// 其中 L 为左侧最近的严格更矮柱子，R 为右侧最近的不高于它的柱子（没有时取 -1 / n）。
+// 只要为每个柱子求出同样的 L、R，结果就与顺序版本完全一致：
+// 1. 各块并行跑单调栈，两侧边界都在块内的柱子直接结算；出栈时栈已空的柱子左边界在块外（左开），
+//    块末仍在栈中的柱子右边界在块外（右开）。
+// 2. 从左到右合并：维护顺序算法处理完前面各块后的全局栈，二分查找左开柱子的 L；
+//    处理完本块后，全局栈 = 其中矮于本块最小值的部分 + 本块末尾的栈。
+// 3. 从右到左合并：维护后面各块的严格前缀最小值序列，二分查找右开柱子的 R。
+// 合并只涉及开放柱子，随机数据下每块只有 O(log n) 个；单调输入时会退化为顺序扫描，但结果不变。
+struct RectChunk {
+    size_t begin, end;
+    long long best;                // 块内结算的最大面积
+    vector<size_t> leftOpen;       // 左开的柱子
+    vector<size_t> leftOpenRight;  // 左开柱子在块内的 R
+    vector<size_t> stack;          // 块末的单调栈（右开的柱子），自底向上高度严格递增
+    vector<size_t> prefixMin;      // 块内严格前缀最小值的位置
 };
 
-int getNextToken(const char *expr, int *pos, double *num, Operator *op) {
-    char c = expr[*pos];
-    if (c == '\0') {
-        *op = EOE;
-        return 0;
-    } else if (c >= '0' && c <= '9') {
-        sscanf(&expr[*pos], "%lf", num);
-        while (expr[*pos] >= '0' && expr[*pos] <= '9' || expr[*pos] == '.') {
-            (*pos)++;
-        }
-        return 1;
-    } else {
-        (*pos)++;
-        switch (c) {
-            case '+': *op = ADD; break;
-            case '-': *op = SUB; break;
-            case '*': *op = MUL; break;
-            case '/': *op = DIV; break;
-            case '^': *op = POW; break;
-            case '!': *op = FAC; break;
-            case '(': *op = L_P; break;
-            case ')': *op = R_P; break;
-            case 's':
-                if (expr[*pos] == 'i' && expr[*pos + 1] == 'n') {
-                    *op = SIN;
-                    (*pos) += 2;
-                } else {
-                    printf("无效的函数名: s%c%c\n", expr[*pos], expr[*pos+1]);
-                    return -1;
-                }
-                break;
-            case 'c':
-                if (expr[*pos] == 'o' && expr[*pos + 1] == 's') {
-                    *op = COS;
-                    (*pos) += 2;
-                } else {
-                    printf("无效的函数名: c%c%c\n", expr[*pos], expr[*pos+1]);
-                    return -1;
-                }
-                break;
-            case 't':
-                if (expr[*pos] == 'a' && expr[*pos + 1] == 'n') {
-                    *op = TAN;
-                    (*pos) += 2;
-                } else {
-                    printf("无效的函数名: t%c%c\n", expr[*pos], expr[*pos+1]);
-                    return -1;
-                }
-                break;
-            case 'l':
-                if (expr[*pos] == 'o' && expr[*pos + 1] == 'g') {
-                    *op = LOG;
-                    (*pos) += 2;
-                } else if (expr[*pos] == 'n') {
-                    *op = LN;
-                    (*pos)++;
-                } else {
-                    printf("无效的函数名: l%c%c\n", expr[*pos], expr[*pos+1]);
-                    return -1;
-                }
-                break;
-            default:
-                printf("无效的字符: %c\n", c);
-                return -1;
+static void scanRectChunk(const int *h, RectChunk &c) {
+    vector<size_t> &st = c.stack;
+    c.best = 0;
+    for (size_t i = c.begin; i < c.end; ++i) {
+        int hi = h[i];
+        while (!st.empty() && h[st.back()] >= hi) {
+            size_t top = st.back();
+            st.pop_back();
+            if (st.empty()) {
+                c.leftOpen.push_back(top);
+                c.leftOpenRight.push_back(i);
+            } else {
+                c.best = max(c.best, (long long)h[top] * (long long)(i - st.back() - 1));
+            }
         }
-        return 0;
+        st.push_back(i);
+        if (c.prefixMin.empty() || hi < h[c.prefixMin.back()]) c.prefixMin.push_back(i);
     }
 }
 
-double calculate(Operator op, OpndStack *opndStack) {
-    double b, a, result = 0;
-    switch (op) {
-        case ADD:
-            b = popOpnd(opndStack);
-            a = popOpnd(opndStack);
-            result = a + b;
-            break;
-        case SUB:
-            b = popOpnd(opndStack);
-            a = popOpnd(opndStack);
-            result = a - b;
-            break;
-        case MUL:
-            b = popOpnd(opndStack);
-            a = popOpnd(opndStack);
-            result = a * b;
-            break;
-        case DIV:
-            b = popOpnd(opndStack);
-            a = popOpnd(opndStack);
-            if (b == 0) {
-                printf("除数不能为0\n");
-                exit(1);
-            }
-            result = a / b;
-            break;
-        case POW:
-            b = popOpnd(opndStack);
-            a = popOpnd(opndStack);
-            result = pow(a, b);
-            break;
-        case FAC:
-            a = popOpnd(opndStack);
-            if (a < 0 || (int)a != a) {
-                printf("阶乘仅适用于非负整数\n");
-                exit(1);
-            }
-            result = 1;
-            for (int i = 1; i <= (int)a; i++) {
-                result *= i;
-            }
-            break;
-        case SIN:
-            a = popOpnd(opndStack);
-            result = sin(a);
-            break;
-        case COS:
-            a = popOpnd(opndStack);
-            result = cos(a);
-            break;
-        case TAN:
-            a = popOpnd(opndStack);
-            result = tan(a);
-            break;
-        case LOG:
-            a = popOpnd(opndStack);
-            if (a <= 0) {
-                printf("对数的参数必须大于0\n");
-                exit(1);
-            }
-            result = log10(a);
-            break;
-        case LN:
-            a = popOpnd(opndStack);
-            if (a <= 0) {
-                printf("自然对数的参数必须大于0\n");
-                exit(1);
+long long largestRectangleParallel(const vector<int> &heights, WorkStealingPool &pool, size_t grain = 1 << 20) {
+    const int *h = heights.data();
+    size_t n = heights.size();
+    size_t chunks = max(size_t(1), n / max(grain, size_t(1)));
+    if (chunks == 1) {
+        vector<size_t> st;
+        return largestRectangleInHistogram(h, n, st);
+    }
+
+    vector<RectChunk> parts(chunks);
+    {
+        TaskGroup group(pool);
+        for (size_t c = 0; c < chunks; ++c) {
+            parts[c].begin = n * c / chunks;
+            parts[c].end = n * (c + 1) / chunks;
+            group.run([h, &parts, c] { scanRectChunk(h, parts[c]); });
+        }
+        group.wait();
+    }
+
+    long long best = 0;
+    for (const RectChunk &c : parts) best = max(best, c.best);
+
+    // 从左到右：global 为顺序算法处理到当前块之前时的栈
+    vector<size_t> global;
+    vector<long long> bottomLeft(chunks);  // 各块栈底柱子的 L
+    auto countBelow = [&](int height) {    // global 中高度 < height 的个数
+        size_t lo = 0, hi = global.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (h[global[mid]] < height) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    };
+    for (size_t c = 0; c < chunks; ++c) {
+        RectChunk &part = parts[c];
+        for (size_t k = 0; k < part.leftOpen.size(); ++k) {
+            size_t i = part.leftOpen[k], below = countBelow(h[i]);
+            long long left = below == 0 ? -1 : (long long)global[below - 1];
+            best = max(best, (long long)h[i] * ((long long)part.leftOpenRight[k] - left - 1));
+        }
+        size_t below = countBelow(h[part.stack[0]]);
+        bottomLeft[c] = below == 0 ? -1 : (long long)global[below - 1];
+        global.resize(below);
+        global.insert(global.end(), part.stack.begin(), part.stack.end());
+    }
+
+    // 从右到左：suffixMin 为后面各块的严格前缀最小值，逆序存放，back 为最靠左（最高）的一个
+    vector<size_t> suffixMin;
+    for (size_t c = chunks; c-- > 0;) {
+        RectChunk &part = parts[c];
+        for (size_t k = 0; k < part.stack.size(); ++k) {
+            size_t i = part.stack[k];
+            size_t lo = 0, hi = suffixMin.size();  // 高度 <= h[i] 的个数
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (h[suffixMin[mid]] <= h[i]) lo = mid + 1;
+                else hi = mid;
             }
-            result = log(a);
-            break;
-        default:
-            printf("无效的运算符\n");
-            exit(1);
+            long long right = lo == 0 ? (long long)n : (long long)suffixMin[lo - 1];
+            long long left = k > 0 ? (long long)part.stack[k - 1] : bottomLeft[c];
+            best = max(best, (long long)h[i] * (right - left - 1));
+        }
+        int minHeight = h[part.stack[0]];
+        while (!suffixMin.empty() && h[suffixMin.back()] >= minHeight) suffixMin.pop_back();
+        suffixMin.insert(suffixMin.end(), part.prefixMin.rbegin(), part.prefixMin.rend());
     }
-    return result;
+    return best;
 }
 
-char priority(Operator op1, Operator op2) {
-    return pri[op1][op2];
+// 不同线程数下并行版本相对顺序版本的加速比
+void testRectangleScaling(BenchReport& report, const BenchConfig& cfg,
+                          const vector<int>& heights, size_t grain = 1 << 20) {
+    cout << "\n=== 并行最大矩形加速比 (n = " << heights.size() << ", grain = " << grain << ") ===\n";
+
+    vector<int> copy(heights);
+    Solution solution;
+    long long expected = 0;
+    BenchResult base = runBenchmark("rect-sequential", "random", heights.size(), cfg, [] {},
+                                    [&] { expected = solution.largestRectangleArea(copy); });
+    report.add(base);
+    cout << "  顺序基准: " << fixed << setprecision(2) << base.median << " " << base.unit
+         << ", 面积 " << expected << "\n";
+
+    for (unsigned t : scalingThreadCounts()) {
+        WorkStealingPool pool(t);
+        long long area = 0;
+        BenchResult r = runBenchmark("rect-parallel-t" + to_string(t), "random", heights.size(), cfg, [] {},
+                                     [&] { area = largestRectangleParallel(heights, pool, grain); });
+        report.add(r);
+        cout << "  " << t << " 线程: " << r.median << " " << r.unit << ", 加速比 " << base.median / r.median
+             << (area == expected ? "" : ", 结果不一致!") << "\n";
+    }
 }
 
-int evaluateExpression(const char *expr, double *result) {
-    OpndStack opndStack;
-    OptrStack optrStack;
-    double num;
-    Operator op, topOp;
-    int pos = 0;
-    int tokenResult;
+// 二值矩阵中全为 1 的最大矩形。矩阵按行位打包：第 i 行从 bits + i * wordsPerRow 开始，
+// 第 j 列是第 j / 64 个字的第 j % 64 位（低位在前）。逐行把每列向上连续 1 的个数
+// 累加到同一个高度缓冲区，再对这一行的直方图求最大矩形；不会展开出 int 矩阵，
+// 额外内存只有 cols 个高度和一个单调栈。
+
+// 用一行的位更新高度：为 1 的列加一，为 0 的列清零；整字全 0 / 全 1 时走快速路径
+static void updateHeights(const uint64_t *row, size_t cols, int *heights) {
+    size_t words = (cols + 63) / 64;
+    for (size_t w = 0; w < words; ++w) {
+        size_t base = w * 64, len = min(size_t(64), cols - base);
+        uint64_t word = row[w];
+        int *h = heights + base;
+        if (word == 0) {
+            memset(h, 0, len * sizeof(int));
+        } else if (len == 64 && word == ~uint64_t(0)) {
+            for (size_t k = 0; k < 64; ++k) h[k]++;
+        } else {
+            for (size_t k = 0; k < len; ++k) h[k] = (h[k] + 1) & -int((word >> k) & 1);
+        }
+    }
+}
 
-    initOpndStack(&opndStack);
-    initOptrStack(&optrStack);
+// 从给定的初始高度出发处理 [rowBegin, rowEnd) 行，heights 会被更新为最后一行的高度
+static long long maximalRectangleRows(const uint64_t *bits, size_t rowBegin, size_t rowEnd, size_t cols,
+                                      size_t wordsPerRow, int *heights, vector<size_t> &st) {
+    long long best = 0;
+    for (size_t i = rowBegin; i < rowEnd; ++i) {
+        updateHeights(bits + i * wordsPerRow, cols, heights);
+        best = max(best, largestRectangleInHistogram(heights, cols, st));
+    }
+    return best;
+}
 
-    pushOptr(&optrStack, EOE);
+long long maximalRectangle(const uint64_t *bits, size_t rows, size_t cols, size_t wordsPerRow) {
+    vector<int> heights(cols, 0);
+    vector<size_t> st;
+    st.reserve(cols + 1);
+    return maximalRectangleRows(bits, 0, rows, cols, wordsPerRow, heights.data(), st);
+}
 
-    while (1) {
-        tokenResult = getNextToken(expr, &pos, &num, &op);
-        if (tokenResult == -1) {
-            return 0;
+// 按行分带并行。一个带的初始高度取决于它上面所有行，分三步：
+// 1. 各带并行只做位更新（不求直方图），得到从 0 出发时带末各列的高度 tail；
+//    某列 tail 等于带高说明整列都是 1，上方的高度会穿过这个带继续累加。
+// 2. 从上到下顺序推出各带的初始高度：carry[b] = tail[b-1] + (tail[b-1] == 带高 ? carry[b-1] : 0)。
+// 3. 各带并行从初始高度出发逐行求直方图最大矩形，取最大值。
+// bandRows 为每带行数，0 表示按线程数自动划分。结果与顺序版本完全一致。
+long long maximalRectangleParallel(const uint64_t *bits, size_t rows, size_t cols, size_t wordsPerRow,
+                                   WorkStealingPool &pool, size_t bandRows = 0) {
+    if (rows == 0 || cols == 0) return 0;
+    if (bandRows == 0) {
+        // 单线程时分带只会多出第 1 步的开销
+        if (pool.size() == 1) return maximalRectangle(bits, rows, cols, wordsPerRow);
+        bandRows = max(size_t(64), (rows + 4 * pool.size() - 1) / (4 * pool.size()));
+    }
+    size_t bands = (rows + bandRows - 1) / bandRows;
+    if (bands == 1) return maximalRectangle(bits, rows, cols, wordsPerRow);
+
+    vector<vector<int> > tail(bands, vector<int>(cols, 0));
+    {
+        TaskGroup group(pool);
+        for (size_t b = 1; b < bands; ++b) {  // 最后一带的 tail 用不到，第 0 带的 tail 也在这里算
+            group.run([&, b] {
+                size_t begin = (b - 1) * bandRows, end = b * bandRows;
+                for (size_t i = begin; i < end; ++i) updateHeights(bits + i * wordsPerRow, cols, tail[b - 1].data());
+            });
         }
-        
-        if (tokenResult == 1) {
-            pushOpnd(&opndStack, num);
-        } else {
-            while (priority(getTopOptr(&optrStack), op) == '>') {
-                topOp = popOptr(&optrStack);
-                if (topOp == EOE) {
-                    *result = getTopOpnd(&opndStack);
-                    return 1;
-                }
-                double res = calculate(topOp, &opndStack);
-                pushOpnd(&opndStack, res);
-            }
+        group.wait();
+    }
 
-            if (priority(getTopOptr(&optrStack), op) == '<') {
-                pushOptr(&optrStack, op);
-            } else if (priority(getTopOptr(&optrStack), op) == '=') {
-                popOptr(&optrStack);
-                if (op != R_P) {
-                    pushOptr(&optrStack, op);
-                }
-            } else {
-                return 0;
-            }
+    // tail[b] 原地改写为第 b 带的初始高度（第 0 带为全 0）
+    vector<int> carry(cols, 0), next(cols);
+    for (size_t b = 0; b < bands; ++b) {
+        if (b + 1 < bands) {
+            int height = int(bandRows);
+            const int *t = tail[b].data();
+            for (size_t j = 0; j < cols; ++j) next[j] = t[j] == height ? t[j] + carry[j] : t[j];
+        }
+        tail[b].swap(carry);
+        carry.swap(next);
+    }
 
-            if (op == EOE && getTopOptr(&optrStack) == EOE) {
-                break;
-            }
+    vector<long long> bandBest(bands, 0);
+    {
+        TaskGroup group(pool);
+        for (size_t b = 0; b < bands; ++b) {
+            group.run([&, b] {
+                vector<size_t> st;
+                st.reserve(cols + 1);
+                size_t begin = b * bandRows, end = min(rows, begin + bandRows);
+                bandBest[b] = maximalRectangleRows(bits, begin, end, cols, wordsPerRow, tail[b].data(), st);
+            });
         }
+        group.wait();
     }
+    return *max_element(bandBest.begin(), bandBest.end());
+}
 
-    *result = getTopOpnd(&opndStack);
-    return 1;
+// 占用栅格上顺序与按行分带并行的对比
+void testMaximalRectangleScaling(BenchReport& report, const BenchConfig& cfg, const vector<uint64_t>& bits,
+                                 size_t rows, size_t cols, size_t stride) {
+    cout << "\n=== 二值矩阵最大矩形 (" << rows << " x " << cols << ", 位打包 "
+         << bits.size() * sizeof(uint64_t) / (1 << 20) << " MB) ===\n";
+
+    long long expected = 0;
+    BenchResult base = runBenchmark("maxrect-sequential", "grid", rows * cols, cfg, [] {},
+                                    [&] { expected = maximalRectangle(bits.data(), rows, cols, stride); });
+    report.add(base);
+    cout << "  顺序基准: " << fixed << setprecision(2) << base.median << " " << base.unit
+         << ", 面积 " << expected << "\n";
+
+    for (unsigned t : scalingThreadCounts()) {
+        WorkStealingPool pool(t);
+        long long area = 0;
+        BenchResult r = runBenchmark("maxrect-parallel-t" + to_string(t), "grid", rows * cols, cfg, [] {},
+                                     [&] { area = maximalRectangleParallel(bits.data(), rows, cols, stride, pool); });
+        report.add(r);
+        cout << "  " << t << " 线程: " << r.median << " " << r.unit << ", 加速比 " << base.median / r.median
+             << (area == expected ? "" : ", 结果不一致!") << "\n";
+    }
 }
 
-// work3.cpp 最大矩形面积相关实现
-class Solution {
+// 最大矩形及其位置：覆盖下标 [start, end]（含两端），高度为 height
+typedef struct {
+    long long area;
+    uint64_t start;
+    uint64_t end;
+    int height;
+} RectangleResult;
+
+// 流式最大矩形：高度分块送入，只保留单调栈，不保存序列本身。
+// 栈中高度严格递增，深度不超过不同高度值的个数，内存与序列长度无关；下标为全局 64 位位置。
+// 负高度按 0 处理。
+class RectangleStream {
 public:
-    int largestRectangleArea(vector<int>& heights) {
-        int n = heights.size();
-        stack<int> st;
-        vector<int> left(n, 0);
-        vector<int> right(n, 0);
+    RectangleStream() { reset(); }
+
+    void reset() {
+        st.clear();
+        position = 0;
+        peakDepth = 0;
+        RectangleResult none = {0, 0, 0, 0};
+        best = none;
+    }
+
+    void push(const int *heights, size_t n) {
+        for (size_t k = 0; k < n; ++k) pushOne(heights[k] > 0 ? heights[k] : 0);
+    }
 
-        for (int i = 0; i < n; ++i) {
-            while (!st.empty() && heights[st.top()] >= heights[i]) {
-                st.pop();
+    void push(const vector<int> &heights) { push(heights.data(), heights.size()); }
+
+    // 到目前为止的最大矩形，包括仍在栈中、延伸到当前末尾的矩形；O(栈深度)，不改变状态
+    RectangleResult current() const {
+        RectangleResult r = best;
+        for (const Bar &b : st) {
+            long long area = (long long)b.height * (long long)(position - b.start);
+            if (area > r.area) {
+                RectangleResult open = {area, b.start, position - 1, b.height};
+                r = open;
             }
-            left[i] = st.empty() ? -1 : st.top();
-            st.push(i);
         }
+        return r;
+    }
 
-        while (!st.empty()) st.pop();
+    uint64_t size() const { return position; }
+    size_t depth() const { return st.size(); }
+    size_t maxDepth() const { return peakDepth; }
+
+private:
+    struct Bar {
+        uint64_t start;  // 以该高度向左能延伸到的最左位置
+        int height;
+    };
 
-        for (int i = n - 1; i >= 0; --i) {
-            while (!st.empty() && heights[st.top()] >= heights[i]) {
-                st.pop();
+    vector<Bar> st;
+    uint64_t position;
+    size_t peakDepth;
+    RectangleResult best;  // 已出栈（右边界确定）的矩形中的最大者
+
+    inline void pushOne(int h) {
+        uint64_t start = position;
+        while (!st.empty() && st.back().height >= h) {
+            const Bar &b = st.back();
+            long long area = (long long)b.height * (long long)(position - b.start);
+            if (area > best.area) {
+                RectangleResult closed = {area, b.start, position - 1, b.height};
+                best = closed;
             }
-            right[i] = st.empty() ? n : st.top();
-            st.push(i);
+            start = b.start;
+            st.pop_back();
         }
+        Bar bar = {start, h};
+        st.push_back(bar);
+        if (st.size() > peakDepth) peakDepth = st.size();
+        position++;
+    }
+};
 
-        int maxArea = 0;
-        for (int i = 0; i < n; ++i) {
-            maxArea = max(maxArea, heights[i] * (right[i] - left[i] - 1));
+// 从文件或管道按块读取以空白或逗号分隔的整数高度并送入流，缓冲区大小固定为 chunkBytes。
+// 遇到无法识别的字符返回 0
+int feedRectangleStream(RectangleStream &rs, FILE *fp, size_t chunkBytes = 1 << 16) {
+    vector<char> buf(chunkBytes);
+    vector<int> batch;
+    batch.reserve(chunkBytes / 2 + 1);
+    long long value = 0;
+    int inNumber = 0, negative = 0;
+    size_t got;
+
+    while ((got = fread(buf.data(), 1, buf.size(), fp)) > 0) {
+        batch.clear();
+        for (size_t i = 0; i < got; ++i) {
+            char c = buf[i];
+            if (c >= '0' && c <= '9') {
+                if (value < INT_MAX) value = value * 10 + (c - '0');
+                inNumber = 1;
+            } else if (c == '-' && !inNumber && !negative) {
+                negative = 1;
+            } else if (isSpaceChar(c) || c == ',') {
+                if (inNumber) batch.push_back(negative ? 0 : (int)min(value, (long long)INT_MAX));
+                else if (negative) return 0;
+                value = 0;
+                inNumber = negative = 0;
+            } else {
+                return 0;
+            }
         }
-
-        return maxArea;
+        rs.push(batch);
     }
-};
+    // 最后一个数字后面可能没有分隔符
+    if (inNumber) {
+        int last = negative ? 0 : (int)min(value, (long long)INT_MAX);
+        rs.push(&last, 1);
+    } else if (negative) {
+        return 0;
+    }
+    return !ferror(fp);
+}
 
 vector<int> generateRandomHeights(int length, int max_height) {
     vector<int> heights;
@@ -528,7 +3184,58 @@ vector<int> generateRandomHeights(int length, int max_height) {
 }
 
 // 主函数，依次执行三个程序的测试
-int main() {
+int main(int argc, char** argv) {
+    BenchOutput benchOutput = parseBenchArgs(argc, argv);
+    BenchConfig benchConfig = benchConfigFor(benchOutput);
+    BenchReport benchReport;
+
+    // --serve 从标准输入读取请求，--serve=端口 监听本地 TCP；--threads=N、--batch=N 可选。
+    // --rect=文件 流式计算文件中高度序列的最大矩形，"-" 表示标准输入；
+    // --rect-n=N 设置并行最大矩形测试的规模（默认 2^20，大规模测试可给 100000000），--grid-n=N 设置二值矩阵测试的边长，
+    // --sort-n=N 设置并行归并排序测试的规模（默认 2^20，目标规模可给 10000000），
+    // --unique-n=N 设置去重测试的最大规模（默认 1000000，按 10 倍递增，目标规模可给 10000000）
+    size_t rectScalingN = 1 << 20, gridN = 8192, sortScalingN = 1 << 20, uniqueN = 1000000;
+    {
+        const char *serve = nullptr, *rectPath = nullptr;
+        unsigned threads = 0;
+        size_t batch = 1024;
+        for (int i = 1; i < argc; ++i) {
+            if (strncmp(argv[i], "--serve", 7) == 0) serve = argv[i] + 7;
+            else if (strncmp(argv[i], "--rect=", 7) == 0) rectPath = argv[i] + 7;
+            else if (strncmp(argv[i], "--rect-n=", 9) == 0) rectScalingN = strtoull(argv[i] + 9, nullptr, 10);
+            else if (strncmp(argv[i], "--grid-n=", 9) == 0) gridN = strtoull(argv[i] + 9, nullptr, 10);
+            else if (strncmp(argv[i], "--sort-n=", 9) == 0) sortScalingN = strtoull(argv[i] + 9, nullptr, 10);
+            else if (strncmp(argv[i], "--unique-n=", 11) == 0) uniqueN = strtoull(argv[i] + 11, nullptr, 10);
+            else if (strncmp(argv[i], "--threads=", 10) == 0) threads = (unsigned)atoi(argv[i] + 10);
+            else if (strncmp(argv[i], "--batch=", 8) == 0) batch = max(1, atoi(argv[i] + 8));
+        }
+        if (serve) {
+            EvalService service(threads);
+            if (*serve == '=') return serveSocket(service, atoi(serve + 1));
+            serveStdin(service, batch);
+            return 0;
+        }
+        if (rectPath) {
+            FILE *fp = strcmp(rectPath, "-") == 0 ? stdin : fopen(rectPath, "rb");
+            if (!fp) {
+                perror(rectPath);
+                return 1;
+            }
+            RectangleStream rs;
+            int ok = feedRectangleStream(rs, fp);
+            if (fp != stdin) fclose(fp);
+            if (!ok) {
+                fprintf(stderr, "%s: 高度序列格式错误\n", rectPath);
+                return 1;
+            }
+            RectangleResult r = rs.current();
+            printf("柱子数 %llu, 最大矩形面积 %lld, 下标 [%llu, %llu], 高度 %d, 栈深度峰值 %zu\n",
+                   (unsigned long long)rs.size(), r.area, (unsigned long long)r.start,
+                   (unsigned long long)r.end, r.height, rs.maxDepth());
+            return 0;
+        }
+    }
+
     // 1. 执行复数相关测试 (work1.cpp)
     cout << "======= 复数向量操作测试 =======" << endl;
     const size_t N = 1000;
@@ -540,7 +3247,7 @@ int main() {
     }
     cout << "\n\n";
 
-    random_shuffle(vec.begin(), vec.end());
+    shuffle(vec.begin(), vec.end(), mt19937(12345));
     cout << "置乱后（前10个）:\n";
     for (size_t i = 0; i < min(size_t(10), vec.size()); ++i) {
         cout << vec[i] << " ";
@@ -556,11 +3263,17 @@ int main() {
 
     auto uniqueVec = uniqueComplex(vec);
     cout << "唯一化后大小: " << uniqueVec.size() << " (原大小: " << vec.size() << ")\n";
+    auto hashedVec = vec;
+    uniqueComplexInPlace(hashedVec);
+    cout << "哈希去重后大小: " << hashedVec.size() << "\n";
+    cout << "近似重复输入的去重对拍 (两种模式): " << checkUniqueComplex(31) << " 处违反\n";
+    testUniqueComplex(benchReport, benchConfig, uniqueN);
 
-    testSortingPerformance(vec);
+    testSortingPerformance(benchReport, benchConfig);
+    testParallelSortScaling(benchReport, benchConfig, generateRandomComplexVector(sortScalingN, 2024));
 
     vector<Complex> sortedForRange = vec;
-    sort(sortedForRange.begin(), sortedForRange.end(), compareComplex);
+    keyedSort(sortedForRange);
     double m1 = 5.0, m2 = 10.0;
     auto rangeResult = rangeFind(sortedForRange, m1, m2);
     cout << "\n区间 [" << m1 << ", " << m2 << ") 内的元素个数: " << rangeResult.size() << "\n";
@@ -568,7 +3281,21 @@ int main() {
     for (size_t i = 0; i < min(size_t(5), rangeResult.size()); ++i) {
         cout << rangeResult[i] << " ";
     }
-    cout << "\n\n";
+    cout << "\n";
+
+    ComplexSet complexSet(vec);
+    cout << "有序集合: 区间内元素个数 " << rangeFind(complexSet, m1, m2).size() << "\n";
+
+    ComplexColumn column(vec);
+    sort(column);
+    auto columnRange = rangeFind(column, m1, m2);
+    cout << "列式存储: 区间内元素个数 " << columnRange.size()
+         << ", 查找 " << vec[0] << ": " << (findComplex(column, vec[0]) ? "找到" : "未找到")
+         << ", 唯一化后大小 " << uniqueComplex(column).size() << "\n";
+
+    cout << "有序集合与 vector 对拍 40000 次操作: " << checkComplexSet(40000, 77) << " 处不一致\n";
+    testComplexSetRange(benchReport, benchConfig);
+    cout << "\n";
 
     // 2. 执行表达式计算测试 (work2.cpp)
     cout << "======= 字符串计算器测试 =======" << endl;
@@ -595,6 +3322,248 @@ int main() {
             printf("表达式无效\n");
         }
     }
+
+    // 错误表达式不再终止程序，而是返回状态码和出错位置；同一个上下文可反复使用
+    {
+        string deep = string(200, '(') + "1" + string(200, ')');
+        const char *badCases[] = {"1/0", "2*(3+4", "3.5!", "ln0", "2#3", "4*", deep.c_str()};
+        EvalContext ctx;
+        initEvalContext(&ctx);
+        cout << "\n错误处理测试:\n";
+        for (size_t i = 0; i < sizeof(badCases) / sizeof(badCases[0]); i++) {
+            double result;
+            const char *shown = i + 1 == sizeof(badCases) / sizeof(badCases[0]) ? "(嵌套200层)1" : badCases[i];
+            if (evaluateExpressionCtx(&ctx, badCases[i], &result) == EVAL_OK) {
+                printf("%s\t%.6f\n", shown, result);
+            } else {
+                printf("%s\t%s (位置 %d)\n", shown, evalStatusMessage(ctx.status), ctx.errorPos);
+            }
+        }
+        freeEvalContext(&ctx);
+    }
+
+    // 阶乘与乘方：double 模式查表/平方求幂，精确模式用任意精度整数
+    {
+        const char *cases[] = {"25!", "2^100", "52!/(5!*47!)", "171!", "1000!/(998!*2)", "3.5^2"};
+        cout << "\ndouble 与精确模式对比:\n";
+        for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+            double value;
+            string exact;
+            EvalContext ctx;
+            initEvalContext(&ctx);
+            EvalStatus st = evaluateExpressionCtx(&ctx, cases[i], &value);
+            freeEvalContext(&ctx);
+            EvalStatus stExact = evaluateExpressionExact(cases[i], &exact);
+            printf("%s\t", cases[i]);
+            if (st == EVAL_OK) printf("%.17g\t", value);
+            else printf("%s\t", evalStatusMessage(st));
+            printf("%s\n", stExact == EVAL_OK ? exact.c_str() : evalStatusMessage(stExact));
+        }
+
+        const int reps = 1 << 20;
+        vector<double> args(reps), exps(reps);
+        mt19937 rng(benchConfig.seed);
+        for (int i = 0; i < reps; i++) {
+            args[i] = rng() % (MAX_DOUBLE_FACTORIAL + 1);
+            exps[i] = int(rng() % (2 * POW_INT_LIMIT + 1)) - POW_INT_LIMIT;
+        }
+        double sink = 0;
+        BenchResult facLoop = runBenchmark("fac-loop", "-", reps, benchConfig, [] {}, [&] {
+            for (int i = 0; i < reps; i++) {
+                double r = 1;
+                for (int k = 1; k <= (int)args[i]; k++) r *= k;
+                sink += r;
+            }
+        });
+        BenchResult facTable = runBenchmark("fac-table", "-", reps, benchConfig, [] {}, [&] {
+            double r = 0;
+            for (int i = 0; i < reps; i++) { applyOperator(FAC, args[i], 0, &r); sink += r; }
+        });
+        BenchResult powLib = runBenchmark("pow-libm", "-", reps, benchConfig, [] {}, [&] {
+            for (int i = 0; i < reps; i++) sink += pow(1.0001 + i * 1e-9, exps[i]);
+        });
+        BenchResult powInt = runBenchmark("pow-squaring", "-", reps, benchConfig, [] {}, [&] {
+            for (int i = 0; i < reps; i++) sink += powerOf(1.0001 + i * 1e-9, exps[i]);
+        });
+        benchReport.add(facLoop);
+        benchReport.add(facTable);
+        benchReport.add(powLib);
+        benchReport.add(powInt);
+        printf("%d 次阶乘 (%s): 逐次相乘 %.3f, 查表 %.3f, 提升 %.1f 倍\n", reps, facTable.unit.c_str(),
+               facLoop.median, facTable.median, facLoop.median / facTable.median);
+        printf("%d 次整数乘方 (%s): pow %.3f, 平方求幂 %.3f, 提升 %.1f 倍\n", reps, powInt.unit.c_str(),
+               powLib.median, powInt.median, powLib.median / powInt.median);
+        doNotOptimize(sink);
+    }
+
+    // 词法分析吞吐量：约 256 KB 的生成表达式，含小数、科学计数法、括号和空白
+    {
+        mt19937 rng(benchConfig.seed);
+        string big = "1";
+        vector<string> literals;
+        const char *ops[] = {" + ", "-", "*", " / "};
+        char buf[64];
+        while (big.size() < (256 << 10)) {
+            switch (rng() % 4) {
+                case 0: snprintf(buf, sizeof(buf), "%u", (unsigned)(rng() % 100000) + 1); break;
+                case 1: snprintf(buf, sizeof(buf), "%u.%03u", (unsigned)(rng() % 1000) + 1, (unsigned)(rng() % 1000)); break;
+                case 2: snprintf(buf, sizeof(buf), "%u.%ue-%u", (unsigned)(rng() % 9) + 1, (unsigned)(rng() % 100), (unsigned)(rng() % 20)); break;
+                default: snprintf(buf, sizeof(buf), "(%u.5+2.25)", (unsigned)(rng() % 100)); break;
+            }
+            big += ops[rng() % 4];
+            big += buf;
+            if (buf[0] != '(') literals.push_back(buf);
+        }
+
+        double mb = big.size() / (1024.0 * 1024.0), sink = 0, value;
+        size_t tokens = 0;
+        BenchResult lex = runBenchmark("lex", "-", big.size(), benchConfig, [] {}, [&] {
+            const char *text = big.c_str();
+            double num, sum = 0;
+            Operator op;
+            int pos = 0, kind;
+            size_t count = 0;
+            while ((kind = getNextToken(text, &pos, &num, &op)) != -1) {
+                count++;
+                if (kind == 1) sum += num;
+                else if (op == EOE) break;
+            }
+            tokens = count;
+            sink += sum;
+        });
+        double bigValue = NAN;
+        BenchResult eval = runBenchmark("lex+eval", "-", big.size(), benchConfig, [] {}, [&] {
+            if (!evaluateExpression(big.c_str(), &bigValue)) bigValue = NAN;
+            sink += bigValue;
+        });
+        BenchResult fast = runBenchmark("parse-number", "-", literals.size(), benchConfig, [] {}, [&] {
+            for (const string &s : literals) { parseNumber(s.c_str(), &value); sink += value; }
+        });
+        BenchResult slow = runBenchmark("sscanf-number", "-", literals.size(), benchConfig, [] {}, [&] {
+            for (const string &s : literals) { sscanf(s.c_str(), "%lf", &value); sink += value; }
+        });
+        benchReport.add(lex);
+        benchReport.add(eval);
+        benchReport.add(fast);
+        benchReport.add(slow);
+        if (lex.unit == "ms") {
+            printf("\n%.2f MB 表达式 (%zu 个记号): 词法分析 %.1f MB/s, 词法+求值 %.1f MB/s, 结果 %g\n",
+                   mb, tokens, mb / (lex.median / 1e3), mb / (eval.median / 1e3), bigValue);
+        } else {
+            printf("\n%.2f MB 表达式 (%zu 个记号): 词法分析 %.2f cycles/B, 词法+求值 %.2f cycles/B, 结果 %g\n",
+                   mb, tokens, lex.median / big.size(), eval.median / big.size(), bigValue);
+        }
+        printf("解析 %zu 个数字 (%s): parseNumber %.3f, sscanf %.3f, 提升 %.1f 倍\n", literals.size(),
+               fast.unit.c_str(), fast.median, slow.median, slow.median / fast.median);
+        doNotOptimize(sink);
+    }
+
+    // 编译一次、反复求值，与每次重新解析对比
+    {
+        const char *formula = "sin2+((1.5+2.25)*3!-2^3^0.5/4)*(7-2.5)/(1+2*3)";
+        const int reps = 100000;
+        CompiledExpr folded, unfolded;
+        compileExpression(formula, &folded);
+        compileExpression(formula, &unfolded, 0);
+        double sink = 0, value = 0;
+        BenchResult parse = runBenchmark("parse-eval", "-", reps, benchConfig, [] {}, [&] {
+            for (int i = 0; i < reps; i++) { evaluateExpression(formula, &value); sink += value; }
+        });
+        BenchResult rpn = runBenchmark("rpn-eval", "-", reps, benchConfig, [] {}, [&] {
+            for (int i = 0; i < reps; i++) { evalCompiled(&unfolded, &value); sink += value; }
+        });
+        BenchResult fold = runBenchmark("rpn-folded", "-", reps, benchConfig, [] {}, [&] {
+            for (int i = 0; i < reps; i++) { evalCompiled(&folded, &value); sink += value; }
+        });
+        benchReport.add(parse);
+        benchReport.add(rpn);
+        benchReport.add(fold);
+        printf("\n%s 求值 %d 次 (%s):\n", formula, reps, parse.unit.c_str());
+        printf("  每次解析: %.3f\n  字节码(%d 条指令): %.3f, 提升 %.1f 倍\n  常量折叠(%d 条指令): %.3f, 提升 %.1f 倍\n",
+               parse.median, (int)unfolded.code.size(), rpn.median, parse.median / rpn.median,
+               (int)folded.code.size(), fold.median, parse.median / fold.median);
+        doNotOptimize(sink);
+    }
+
+    // 变量绑定到数据列，整列批量求值；第二个公式含整数指数乘方，逐位核对两种方式的结果
+    {
+        const char *formulas[] = {"(x*x+y*y)/(1+x)-y^2*0.5", "x^3-(x+y)^5*0.01+1/y^3"};
+        const char *labels[] = {"arith", "pow"};
+        const size_t rows = 1 << 16;
+        vector<double> xs(rows), ys(rows), out(rows), expected(rows);
+        for (size_t i = 0; i < rows; ++i) {
+            xs[i] = 0.001 * i;
+            ys[i] = 3.0 - 0.0005 * i;
+        }
+        map<string, const double *> named;
+        named["x"] = xs.data();
+        named["y"] = ys.data();
+        for (int f = 0; f < 2; ++f) {
+            CompiledExpr prog;
+            vector<const double *> columns;
+            if (!compileExpression(formulas[f], &prog) || !bindColumns(&prog, named, &columns)) continue;
+            BenchResult rowwise = runBenchmark("rowwise-eval", labels[f], rows, benchConfig, [] {}, [&] {
+                double vals[2];
+                for (size_t i = 0; i < rows; ++i) {
+                    for (size_t v = 0; v < columns.size(); ++v) vals[v] = columns[v][i];
+                    if (!evalCompiled(&prog, &expected[i], vals)) expected[i] = NAN;
+                }
+            });
+            BenchResult batch = runBenchmark("batch-eval", labels[f], rows, benchConfig, [] {}, [&] {
+                evalBatch(&prog, columns.data(), rows, out.data());
+            });
+            benchReport.add(rowwise);
+            benchReport.add(batch);
+            size_t differ = 0;
+            for (size_t i = 0; i < rows; ++i) {
+                bool bothNan = out[i] != out[i] && expected[i] != expected[i];
+                differ += !bothNan && memcmp(&out[i], &expected[i], sizeof(double)) != 0;
+            }
+            printf("%s 对 %zu 行求值 (%s): 逐行 %.3f, 批量 %.3f, 提升 %.1f 倍; out[100] = %.6f, 与逐行结果不同 %zu 行\n",
+                   formulas[f], rows, batch.unit.c_str(), rowwise.median, batch.median,
+                   rowwise.median / batch.median, out[100], differ);
+        }
+    }
+
+    // 求值服务：大量重复的表达式文本经缓存只编译一次，批量请求由线程池并行求值
+    {
+        const int distinct = 2000, total = 100000;
+        mt19937 rng(benchConfig.seed);
+        vector<string> formulas;
+        char buf[96];
+        for (int i = 0; i < distinct; i++) {
+            int a = rng() % 100, b = rng() % 10, c = rng() % 7;
+            if (i % 100 == 99) snprintf(buf, sizeof(buf), "%d/(%d-%d)", a, b, b);  // 少量除零请求
+            else snprintf(buf, sizeof(buf), "(%d.5+%d)*%d!-%d^2/(1+%d)", a, b, c, b, a);
+            formulas.push_back(buf);
+        }
+        // 80% 的请求落在前 10% 的表达式上
+        vector<EvalRequest> reqs(total);
+        for (int i = 0; i < total; i++) {
+            int k = rng() % 10 < 8 ? rng() % (distinct / 10) : rng() % distinct;
+            reqs[i].expr = formulas[k];
+        }
+
+        EvalService service(0, 1024);
+        vector<EvalResponse> resps;
+        double sink = 0;
+        BenchResult direct = runBenchmark("direct-eval", "-", total, benchConfig, [] {}, [&] {
+            double value;
+            for (int i = 0; i < total; i++) {
+                if (evaluateExpression(reqs[i].expr.c_str(), &value)) sink += value;
+            }
+        });
+        BenchResult served = runBenchmark("service-eval", "-", total, benchConfig, [] {}, [&] {
+            service.evaluateBatch(reqs, resps);
+        });
+        benchReport.add(direct);
+        benchReport.add(served);
+        printf("求值服务 %d 个请求 / %d 个不同表达式 (%s): 直接求值 %.3f, 服务 %.3f (%u 线程), 提升 %.1f 倍\n",
+               total, distinct, served.unit.c_str(), direct.median, served.median, service.threads(),
+               direct.median / served.median);
+        printServiceStats(stdout, service);
+        doNotOptimize(sink);
+    }
     cout << endl;
 
     // 3. 执行最大矩形面积测试 (work3.cpp)
@@ -636,5 +3605,81 @@ int main() {
         cout << "输出: " << solution.largestRectangleArea(heights) << endl << endl;
     }
 
+    // 流式接口：分块送入，随时查询当前最大矩形及其位置
+    {
+        RectangleStream rs;
+        const int part1[] = {2, 1, 5}, part2[] = {6, 2, 3};
+        rs.push(part1, 3);
+        RectangleResult r1 = rs.current();
+        rs.push(part2, 3);
+        RectangleResult r2 = rs.current();
+        printf("流式: 送入 [2, 1, 5] 后最大面积 %lld (下标 %llu-%llu)，再送入 [6, 2, 3] 后 %lld (下标 %llu-%llu, 高度 %d)\n",
+               r1.area, (unsigned long long)r1.start, (unsigned long long)r1.end,
+               r2.area, (unsigned long long)r2.start, (unsigned long long)r2.end, r2.height);
+
+        // 随机分块与整体计算结果一致
+        mt19937 rng(benchConfig.seed);
+        int mismatches = 0;
+        for (int t = 0; t < 200; ++t) {
+            vector<int> h(rng() % 300 + 1);
+            for (int &x : h) x = rng() % 50;
+            RectangleStream chunked;
+            for (size_t pos = 0; pos < h.size();) {
+                size_t len = min(h.size() - pos, size_t(rng() % 17 + 1));
+                chunked.push(h.data() + pos, len);
+                pos += len;
+            }
+            RectangleResult r = chunked.current();
+            long long check = 0;
+            for (uint64_t k = r.start; k <= r.end && r.area > 0; ++k) check += h[k] >= r.height;
+            if (r.area != solution.largestRectangleArea(h) || (r.area > 0 && check * r.height != r.area)) mismatches++;
+        }
+        printf("随机分块 200 组与整体计算对比: %d 组不一致\n", mismatches);
+
+        // 吞吐量：一遍扫描 vs 按 64K 分块流式送入
+        const size_t n = 10000000, chunk = 1 << 16;
+        vector<int> big(n);
+        for (size_t i = 0; i < n; ++i) big[i] = rng() % 100000;
+        long long sink = 0;
+        BenchResult whole = runBenchmark("rect-onepass", "-", n, benchConfig, [] {}, [&] {
+            sink += solution.largestRectangleArea(big);
+        });
+        BenchResult stream = runBenchmark("rect-stream", "-", n, benchConfig, [] {}, [&] {
+            RectangleStream s;
+            for (size_t pos = 0; pos < n; pos += chunk) s.push(big.data() + pos, min(chunk, n - pos));
+            sink += s.current().area;
+        });
+        benchReport.add(whole);
+        benchReport.add(stream);
+        printf("%zu 个柱子 (%s): 一遍扫描 %.3f, 流式分块 %.3f\n", n, whole.unit.c_str(), whole.median, stream.median);
+        doNotOptimize(sink);
+
+        // 大规模数据：高度上限接近 INT_MAX，面积超出 int 范围；并行分治与顺序结果逐一核对
+        vector<int> huge(rectScalingN);
+        for (size_t i = 0; i < huge.size(); ++i) huge[i] = INT_MAX - int(rng() % 1000000);
+        // 默认规模较小时缩小分块，保证仍有十几个块走跨块合并
+        testRectangleScaling(benchReport, benchConfig, huge, min(size_t(1) << 20, max(size_t(1) << 12, huge.size() / 16)));
+        vector<int>().swap(huge);
+
+        vector<vector<char> > matrix = {{'1', '0', '1', '0', '0'},
+                                        {'1', '0', '1', '1', '1'},
+                                        {'1', '1', '1', '1', '1'},
+                                        {'1', '0', '0', '1', '0'}};
+        cout << "\n二值矩阵示例的最大全 1 矩形面积: " << solution.maximalRectangle(matrix) << "\n";
+
+        // 占用栅格：全 1 背景上随机放置若干矩形障碍（0）
+        size_t rows = gridN, cols = gridN, stride = (cols + 63) / 64;
+        vector<uint64_t> grid(rows * stride, ~uint64_t(0));
+        for (int k = 0; k < 4000; ++k) {
+            size_t r0 = rng() % rows, c0 = rng() % cols;
+            size_t r1 = min(rows, r0 + 1 + rng() % 64), c1 = min(cols, c0 + 1 + rng() % 64);
+            for (size_t i = r0; i < r1; ++i) {
+                for (size_t j = c0; j < c1; ++j) grid[i * stride + j / 64] &= ~(uint64_t(1) << (j % 64));
+            }
+        }
+        testMaximalRectangleScaling(benchReport, benchConfig, grid, rows, cols, stride);
+    }
+
+    writeBenchOutput(benchReport, benchOutput);
     return 0;
 }
\ No newline at end of file
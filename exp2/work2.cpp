@@ -1,177 +1,2399 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <queue>
 #include <map>
 #include <string>
 #include <cstring>
 #include <algorithm>
 #include <cctype>   // for tolower, isalpha
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <vector>
+#include <random>
+#include <iomanip>
+#include <atomic>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__) || defined(__SSE2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <errno.h>
+#define BITMAP_HAS_MMAP 1
+#elif defined(_MSC_VER)
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+#include "../common/benchmark.h"
+#include "../common/task_pool.h"
 using namespace std;
 
-typedef int Rank;
+typedef long long Rank;  // 64 位，支持多 GB 的位图
+
+// ====================== 64 位字的位运算 ======================
+// 以 -mpopcnt / -mbmi / -march=native 编译时各自对应单条 popcnt / tzcnt 指令
+inline int popcount64(uint64_t w) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return int(__popcnt64(w));
+#elif defined(__GNUC__)
+    return __builtin_popcountll(w);
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return int((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// 最低置位的下标，w 不能为 0
+inline int ctz64(uint64_t w) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, w);
+    return int(i);
+#elif defined(__GNUC__)
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    for (; !(w & 1); w >>= 1) n++;
+    return n;
+#endif
+}
+
+// w 中第 j 个（从 0 起）置位的下标，要求 j < popcount64(w)
+inline int selectInWord(uint64_t w, int j) {
+#if defined(__BMI2__)
+    return ctz64(_pdep_u64(uint64_t(1) << j, w));
+#else
+    for (; j > 0; --j) w &= w - 1;
+    return ctz64(w);
+#endif
+}
+
+// 旧文件格式是字节流、每字节高位在前；字内则是低位在前。
+// 两者互转只需翻转每个字节内的位序（大端机器另需交换字节序），变换是自逆的
+inline uint64_t swapByteBitOrder(uint64_t w) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    w = __builtin_bswap64(w);
+#endif
+    w = ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    w = ((w >> 2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) << 2);
+    w = ((w >> 1) & 0x5555555555555555ULL) | ((w & 0x5555555555555555ULL) << 1);
+    return w;
+}
+
+// 逐字二元运算：标量、SSE2、AVX2 三种宽度，ANDNOT 为 a & ~b
+struct WordAnd {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a & b; }
+#if defined(__SSE2__)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_and_si128(a, b); }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_and_si256(a, b); }
+#endif
+};
+struct WordOr {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a | b; }
+#if defined(__SSE2__)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_or_si128(a, b); }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_or_si256(a, b); }
+#endif
+};
+struct WordXor {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a ^ b; }
+#if defined(__SSE2__)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_xor_si128(a, b); }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_xor_si256(a, b); }
+#endif
+};
+struct WordAndNot {
+    static uint64_t apply(uint64_t a, uint64_t b) { return a & ~b; }
+#if defined(__SSE2__)
+    static __m128i apply(__m128i a, __m128i b) { return _mm_andnot_si128(b, a); }
+#endif
+#if defined(__AVX2__)
+    static __m256i apply(__m256i a, __m256i b) { return _mm256_andnot_si256(b, a); }
+#endif
+};
+
+// dst[i] = Op(dst[i], src[i])，i < n
+template <class Op>
+void combineWords(uint64_t* dst, const uint64_t* src, Rank n) {
+    Rank i = 0;
+#if defined(__AVX2__)
+    for (; i + 4 <= n; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), Op::apply(a, b));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= n; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), Op::apply(a, b));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = Op::apply(dst[i], src[i]);
+}
+
+inline Rank popcountWords(const uint64_t* w, Rank n) {
+    Rank cnt = 0;
+    for (Rank i = 0; i < n; i++) cnt += popcount64(w[i]);
+    return cnt;
+}
+
+// ====================== 位图 ======================
+// 第 k 位存于 M[k >> 6] 的第 (k & 63) 位；_sz 始终等于置位总数。
+// 秩/选择索引按 rank9 组织：每 8 字（512 位）一块，存块前缀置位数和块内
+// 第 1..7 字之前的置位数（每个 9 位打包进一个字），额外空间为 25%，
+// rank(k) 只需两次读索引加一次 popcnt；select 先按采样缩小块范围再二分。
+// 索引在首次 rank/select 时构建，任何修改都会使其失效
+#define RANK_BLOCK_WORDS 8
+#define SELECT_SAMPLE 4096  // 每隔多少个置位记录一次所在块
+
+// 映射文件格式：64 字节文件头 + 按本机字节序存放的字数组，映射后数据区可直接当 M 使用。
+// 文件头记下字数与置位数，打开时无需扫描数据；共享映射第一次写入时先置 DIRTY，
+// sync() 写回数据后才更新置位数并清除 DIRTY，中途崩溃的文件下次打开会重新计数
+#define BITMAP_FILE_MAGIC "DSBITMAP"
+#define BITMAP_FILE_VERSION 1
+#define BITMAP_FILE_BYTE_ORDER 0x01020304u
+#define BITMAP_FILE_DIRTY 1
+
+struct BitmapFileHeader {
+    char magic[8];
+    uint32_t byteOrder;    // 读出的值不是 BITMAP_FILE_BYTE_ORDER 说明文件来自不同字节序的机器
+    uint32_t version;
+    uint64_t headerBytes;  // 数据区偏移
+    uint64_t words;
+    uint64_t popcount;
+    uint64_t flags;
+    uint64_t reserved[2];
+};
+static_assert(sizeof(BitmapFileHeader) == 64, "BitmapFileHeader must stay 64 bytes");
+
+// 文件长度与定位用 64 位偏移；long 在 Windows 和 32 位平台上只有 32 位，ftell / fseek 过 2 GB 就失败
+static bool fileBytes64(FILE* fp, uint64_t* bytes) {
+#if defined(BITMAP_HAS_MMAP)
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0) return false;
+    *bytes = uint64_t(st.st_size);
+    return true;
+#elif defined(_MSC_VER)
+    struct _stat64 st;
+    if (_fstat64(_fileno(fp), &st) != 0) return false;
+    *bytes = uint64_t(st.st_size);
+    return true;
+#else
+    long n = fseek(fp, 0, SEEK_END) == 0 ? ftell(fp) : -1;
+    if (n < 0 || fseek(fp, 0, SEEK_SET) != 0) return false;
+    *bytes = uint64_t(n);
+    return true;
+#endif
+}
+
+static bool seek64(FILE* fp, uint64_t offset) {
+#if defined(BITMAP_HAS_MMAP)
+    return uint64_t(off_t(offset)) == offset && fseeko(fp, off_t(offset), SEEK_SET) == 0;
+#elif defined(_MSC_VER)
+    return offset <= uint64_t(LLONG_MAX) && _fseeki64(fp, (__int64)offset, SEEK_SET) == 0;
+#else
+    return offset <= uint64_t(LONG_MAX) && fseek(fp, long(offset), SEEK_SET) == 0;
+#endif
+}
+
+// 位图的存储方式：堆上分配，或映射文件（只读 / 写时复制 / 共享写回）
+enum BitmapStorage { BITMAP_HEAP, BITMAP_MAP_READONLY, BITMAP_MAP_PRIVATE, BITMAP_MAP_SHARED };
 
 class Bitmap {
 private:
-    unsigned char* M;
-    Rank N, _sz;
+    uint64_t* M;
+    Rank N, _sz;                 // N：字数；_sz：置位总数
+    vector<uint64_t> rankIndex;  // 每块两个字：块前缀置位数、块内打包计数；末尾为总数
+    vector<Rank> selectHint;     // 第 i * SELECT_SAMPLE 个置位所在的块
+    bool indexValid;
+    BitmapStorage storage;
+    unsigned char* mapBase;      // 映射起点（文件头）；堆上存储时为 NULL
+    size_t mapBytes;
+    int mapFd;                   // 仅共享映射保留，用于扩容时 ftruncate
 protected:
     void init(Rank n) {
-        M = new unsigned char[N = (n + 7) / 8];
-        memset(M, 0, N);
+        N = (n + 63) >> 6;
+        M = new uint64_t[N];
+        memset(M, 0, sizeof(uint64_t) * N);
         _sz = 0;
+        indexValid = false;
+        storage = BITMAP_HEAP;
+        mapBase = NULL;
+        mapBytes = 0;
+        mapFd = -1;
+    }
+    BitmapFileHeader* header() { return (BitmapFileHeader*)mapBase; }
+    // 释放存储；共享映射先写回
+    void release() {
+        if (storage == BITMAP_HEAP) {
+            delete[] M;
+        } else {
+            if (storage == BITMAP_MAP_SHARED) sync();
+            unmap();
+        }
+        M = NULL;
+    }
+    void unmap() {
+#ifdef BITMAP_HAS_MMAP
+        munmap(mapBase, mapBytes);
+        if (mapFd >= 0) close(mapFd);
+#endif
+        mapBase = NULL;
+        mapBytes = 0;
+        mapFd = -1;
+        storage = BITMAP_HEAP;
+    }
+    // 把映射中的数据复制到堆上（容量为 words 字），之后与映射文件无关
+    void detach(Rank words) {
+        uint64_t* heap = new uint64_t[words];
+        memcpy(heap, M, sizeof(uint64_t) * min(N, words));
+        if (words > N) memset(heap + N, 0, sizeof(uint64_t) * (words - N));
+        if (storage == BITMAP_MAP_SHARED) sync();
+        unmap();
+        M = heap;
+        N = words;
+    }
+    // 修改数据前调用：只读映射先复制到堆上，共享映射先标记 DIRTY
+    void beforeWrite() {
+        if (storage == BITMAP_MAP_READONLY) detach(N);
+        else if (storage == BITMAP_MAP_SHARED && !(header()->flags & BITMAP_FILE_DIRTY))
+            header()->flags |= BITMAP_FILE_DIRTY;
+    }
+    // 共享映射扩容：先加长文件再重新映射，数据区偏移沿用文件头中的 headerBytes；
+    // 失败时退回堆上存储，不丢数据
+    bool remapShared(Rank words) {
+#ifdef BITMAP_HAS_MMAP
+        size_t offset = size_t(header()->headerBytes);
+        size_t bytes = offset + sizeof(uint64_t) * size_t(words);
+        if (ftruncate(mapFd, off_t(bytes)) != 0) return false;
+        void* base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, mapFd, 0);
+        if (base == MAP_FAILED) return false;
+        munmap(mapBase, mapBytes);
+        mapBase = (unsigned char*)base;
+        mapBytes = bytes;
+        M = (uint64_t*)(mapBase + offset);
+        N = words;
+        header()->words = uint64_t(words);
+        header()->flags |= BITMAP_FILE_DIRTY;
+        return true;
+#else
+        (void)words;
+        return false;
+#endif
+    }
+    void resizeWords(Rank words) {
+        if (storage == BITMAP_MAP_SHARED && remapShared(words)) return;
+        if (storage != BITMAP_HEAP) {
+            detach(words);
+            return;
+        }
+        uint64_t* oldM = M;
+        Rank oldN = N;
+        M = new uint64_t[words];
+        memcpy(M, oldM, sizeof(uint64_t) * min(oldN, words));
+        if (words > oldN) memset(M + oldN, 0, sizeof(uint64_t) * (words - oldN));
+        N = words;
+        delete[] oldM;
+    }
+    // 清掉第 n 位及之后的位
+    void truncateBits(Rank n) {
+        Rank w = n >> 6;
+        if (w >= N) return;
+        M[w] &= (uint64_t(1) << (n & 63)) - 1;
+        if (w + 1 < N) memset(M + w + 1, 0, sizeof(uint64_t) * (N - w - 1));
+    }
+    template <class Op>
+    Bitmap& combine(const Bitmap& B, bool growToB, bool clearBeyondB) {
+        if (growToB && B.N > N) resizeWords(B.N);
+        beforeWrite();
+        Rank common = min(N, B.N);
+        combineWords<Op>(M, B.M, common);
+        if (clearBeyondB && N > common) memset(M + common, 0, sizeof(uint64_t) * (N - common));
+        _sz = popcountWords(M, N);
+        indexValid = false;
+        return *this;
     }
 public:
     Bitmap(Rank n = 8) { init(n); }
-    
-    Bitmap(char* file, Rank n = 8) {
+
+    // 读入旧格式文件（字节流，每字节高位在前）的前 n 位
+    Bitmap(const char* file, Rank n = 8) {
         init(n);
         FILE* fp = fopen(file, "rb");
         if (fp) {
-            fread(M, sizeof(char), N, fp);
+            size_t got = fread(M, 1, (size_t(n) + 7) / 8, fp);
             fclose(fp);
+            (void)got;
+            for (Rank i = 0; i < N; i++) M[i] = swapByteBitOrder(M[i]);
         }
-        Rank cnt = 0;  // ✅ 修复：cnt 声明在循环外
-        for (Rank k = 0; k < n; k++) {
-            if (test(k)) cnt++;
-        }
-        _sz = cnt;
+        truncateBits(n);
+        _sz = popcountWords(M, N);
     }
-    
-    ~Bitmap() { delete[] M; M = NULL; _sz = 0; }
+
+    // 复制得到的总是堆上的位图
+    Bitmap(const Bitmap& B) { init(0); *this = B; }
+    Bitmap& operator=(const Bitmap& B) {
+        if (this == &B) return *this;
+        release();
+        N = B.N;
+        M = new uint64_t[N];
+        memcpy(M, B.M, sizeof(uint64_t) * N);
+        _sz = B._sz;
+        indexValid = false;
+        return *this;
+    }
+
+    ~Bitmap() { release(); _sz = 0; }
 
     Rank size() { return _sz; }
+    Rank capacity() { return N * 64; }
+    BitmapStorage storageMode() const { return storage; }
     void set(Rank k) {
+        if (k < 0) return;
         expand(k);
-        _sz++;
-        M[k >> 3] |= (0x80 >> (k & 0x07));
+        uint64_t bit = uint64_t(1) << (k & 63);
+        if (!(M[k >> 6] & bit)) {
+            beforeWrite();
+            M[k >> 6] |= bit;
+            _sz++;
+            indexValid = false;
+        }
     }
     void clear(Rank k) {
-        expand(k);
-        _sz--;
-        M[k >> 3] &= ~(0x80 >> (k & 0x07));
+        if (k < 0 || (k >> 6) >= N) return;
+        uint64_t bit = uint64_t(1) << (k & 63);
+        if (M[k >> 6] & bit) {
+            beforeWrite();
+            M[k >> 6] &= ~bit;
+            _sz--;
+            indexValid = false;
+        }
     }
-    bool test(Rank k) {
-        expand(k);
-        return M[k >> 3] & (0x80 >> (k & 0x07));
+    // 越界的位视为 0，不会触发扩容
+    bool test(Rank k) const {
+        return k >= 0 && (k >> 6) < N && ((M[k >> 6] >> (k & 63)) & 1);
     }
-    void dump(char* file) {
+    // 写出旧格式：字节流，每字节高位在前；任何一步写失败都返回 false
+    bool dump(const char* file) {
         FILE* fp = fopen(file, "wb");
-        fwrite(M, sizeof(char), N, fp);
+        if (!fp) return false;
+        uint64_t buf[512];
+        bool ok = true;
+        for (Rank i = 0; ok && i < N; i += 512) {
+            Rank cnt = min(N - i, Rank(512));
+            for (Rank j = 0; j < cnt; j++) buf[j] = swapByteBitOrder(M[i + j]);
+            ok = fwrite(buf, sizeof(uint64_t), size_t(cnt), fp) == size_t(cnt);
+        }
+        return (fclose(fp) == 0) && ok;
+    }
+
+    // 以映射文件格式写出（文件头 + 字数组），可被 mapFile() 直接映射
+    bool save(const char* file) const {
+        BitmapFileHeader h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, BITMAP_FILE_MAGIC, 8);
+        h.byteOrder = BITMAP_FILE_BYTE_ORDER;
+        h.version = BITMAP_FILE_VERSION;
+        h.headerBytes = sizeof(h);
+        h.words = uint64_t(N);
+        h.popcount = uint64_t(_sz);
+        FILE* fp = fopen(file, "wb");
+        if (!fp) return false;
+        bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 && fwrite(M, sizeof(uint64_t), size_t(N), fp) == size_t(N);
+        return (fclose(fp) == 0) && ok;
+    }
+
+    // 映射 save() 写出的文件，不复制数据、不扫描计数。
+    //   BITMAP_MAP_READONLY：只读映射，第一次修改时复制到堆上，文件不变；
+    //   BITMAP_MAP_PRIVATE：写时复制映射，只有改过的页各自复制，文件不变；
+    //   BITMAP_MAP_SHARED：读写映射，修改经 sync()（析构时也会调用）写回文件。
+    // 失败（文件不存在、格式或字节序不符、长度不足）返回 false，原内容不变。
+    // 不支持 mmap 的平台上只读 / 写时复制退化为整体读入，共享模式不可用
+    bool mapFile(const char* file, BitmapStorage mode) {
+        if (mode == BITMAP_HEAP) return load(file);
+#ifdef BITMAP_HAS_MMAP
+        int fd = open(file, mode == BITMAP_MAP_SHARED ? O_RDWR : O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        void* base = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && uint64_t(st.st_size) >= sizeof(BitmapFileHeader) && uint64_t(st.st_size) <= SIZE_MAX)
+            base = mmap(NULL, size_t(st.st_size), mode == BITMAP_MAP_READONLY ? PROT_READ : PROT_READ | PROT_WRITE,
+                        mode == BITMAP_MAP_PRIVATE ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        const BitmapFileHeader* h = (const BitmapFileHeader*)base;
+        if (!validHeader(*h, uint64_t(st.st_size))) {
+            munmap(base, size_t(st.st_size));
+            close(fd);
+            return false;
+        }
+        release();
+        storage = mode;
+        mapBase = (unsigned char*)base;
+        mapBytes = size_t(st.st_size);
+        M = (uint64_t*)(mapBase + h->headerBytes);
+        N = Rank(h->words);
+        _sz = Rank(h->popcount);
+        indexValid = false;
+        if (mode == BITMAP_MAP_SHARED) mapFd = fd;
+        else close(fd);
+        if (h->flags & BITMAP_FILE_DIRTY) _sz = popcountWords(M, N);  // 上次没有 sync 完
+        return true;
+#else
+        return mode != BITMAP_MAP_SHARED && load(file);
+#endif
+    }
+
+    // 把 save() 写出的文件整体读入堆上
+    bool load(const char* file) {
+        FILE* fp = fopen(file, "rb");
+        if (!fp) return false;
+        BitmapFileHeader h;
+        uint64_t fileBytes = 0;
+        bool ok = fileBytes64(fp, &fileBytes) && fileBytes >= sizeof(h) && fread(&h, sizeof(h), 1, fp) == 1 &&
+                  validHeader(h, fileBytes) && seek64(fp, h.headerBytes);
+        uint64_t* words = ok ? new uint64_t[size_t(h.words)] : NULL;
+        ok = ok && fread(words, sizeof(uint64_t), size_t(h.words), fp) == size_t(h.words);
         fclose(fp);
+        if (!ok) {
+            delete[] words;
+            return false;
+        }
+        release();
+        storage = BITMAP_HEAP;
+        M = words;
+        N = Rank(h.words);
+        _sz = (h.flags & BITMAP_FILE_DIRTY) ? popcountWords(M, N) : Rank(h.popcount);
+        indexValid = false;
+        return true;
+    }
+
+    // 共享映射：先把数据刷到文件，再写入置位数并清除 DIRTY；其它存储方式没有可写回的内容，返回 false
+    bool sync() {
+#ifdef BITMAP_HAS_MMAP
+        if (storage != BITMAP_MAP_SHARED) return false;
+        if (!(header()->flags & BITMAP_FILE_DIRTY)) return true;
+        if (msync(mapBase, mapBytes, MS_SYNC) != 0) return false;
+        header()->popcount = uint64_t(_sz);
+        header()->flags &= ~uint64_t(BITMAP_FILE_DIRTY);
+        return msync(mapBase, sizeof(BitmapFileHeader), MS_SYNC) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // 数据区须能整体放进地址空间（32 位平台上限制字数）
+    static bool validHeader(const BitmapFileHeader& h, uint64_t fileBytes) {
+        return memcmp(h.magic, BITMAP_FILE_MAGIC, 8) == 0 && h.byteOrder == BITMAP_FILE_BYTE_ORDER &&
+               h.version == BITMAP_FILE_VERSION && h.headerBytes >= sizeof(BitmapFileHeader) && h.headerBytes % 8 == 0 && h.headerBytes <= fileBytes &&
+               h.words <= (fileBytes - h.headerBytes) / sizeof(uint64_t) && h.words <= uint64_t(LLONG_MAX >> 6) &&
+               h.words <= uint64_t(SIZE_MAX / sizeof(uint64_t));
     }
     char* bits2string(Rank n) {
-        expand(n - 1);
         char* s = new char[n + 1];
         s[n] = '\0';
         for (Rank i = 0; i < n; i++)
             s[i] = test(i) ? '1' : '0';
         return s;
     }
+    // 容量扩到至少 2k+1 位
     void expand(Rank k) {
-        if (k < 8 * N) return;
-        Rank oldN = N;
-        unsigned char* oldM = M;
-        init(2 * k + 1);
-        memcpy(M, oldM, oldN);
-        delete[] oldM;
+        if ((k >> 6) < N) return;
+        resizeWords((2 * k + 1 + 63) >> 6);
+        indexValid = false;
+    }
+
+    // 重新逐字 popcnt 统计置位数
+    Rank count() const { return popcountWords(M, N); }
+
+    // 逐字位运算；OR/XOR 会把容量扩到与 B 一致，B 之外的位对 AND 视为 0、对 ANDNOT 视为保持
+    Bitmap& operator&=(const Bitmap& B) { return combine<WordAnd>(B, false, true); }
+    Bitmap& operator|=(const Bitmap& B) { return combine<WordOr>(B, true, false); }
+    Bitmap& operator^=(const Bitmap& B) { return combine<WordXor>(B, true, false); }
+    Bitmap& andNot(const Bitmap& B) { return combine<WordAndNot>(B, false, false); }
+
+    // 不小于 k 的第一个置位；没有则返回 -1
+    Rank findNext(Rank k) const {
+        if (k < 0) k = 0;
+        Rank w = k >> 6;
+        if (w >= N) return -1;
+        uint64_t bits = M[w] & (~uint64_t(0) << (k & 63));
+        while (!bits) {
+            if (++w == N) return -1;
+            bits = M[w];
+        }
+        return (w << 6) + ctz64(bits);
+    }
+    Rank findFirst() const { return findNext(0); }
+    // 按升序对每个置位调用 visit(k)，逐字清最低位，比反复 findNext 少一次定位
+    template <class Visit>
+    void forEach(Visit visit) const {
+        for (Rank w = 0; w < N; w++)
+            for (uint64_t bits = M[w]; bits; bits &= bits - 1) visit((w << 6) + ctz64(bits));
+    }
+
+    void buildRankIndex() {
+        if (indexValid) return;
+        Rank blocks = (N + RANK_BLOCK_WORDS - 1) / RANK_BLOCK_WORDS;
+        rankIndex.assign(2 * size_t(blocks) + 1, 0);
+        selectHint.clear();
+        Rank total = 0, nextSample = 0;
+        for (Rank b = 0; b < blocks; b++) {
+            rankIndex[2 * b] = total;
+            uint64_t packed = 0;
+            Rank inBlock = 0;
+            for (Rank t = 0; t < RANK_BLOCK_WORDS; t++) {
+                if (t) packed |= uint64_t(inBlock) << (9 * (t - 1));
+                Rank w = b * RANK_BLOCK_WORDS + t;
+                if (w < N) inBlock += popcount64(M[w]);
+            }
+            rankIndex[2 * b + 1] = packed;
+            total += inBlock;
+            for (; nextSample < total; nextSample += SELECT_SAMPLE) selectHint.push_back(b);
+        }
+        rankIndex[2 * blocks] = total;
+        indexValid = true;
+    }
+
+    // [0, k) 内的置位数
+    Rank rank(Rank k) {
+        if (k <= 0) return 0;
+        if ((k >> 6) >= N) return _sz;
+        buildRankIndex();
+        Rank w = k >> 6, b = w / RANK_BLOCK_WORDS, t = w % RANK_BLOCK_WORDS;
+        Rank r = Rank(rankIndex[2 * b]);
+        if (t) r += Rank((rankIndex[2 * b + 1] >> (9 * (t - 1))) & 0x1FF);
+        return r + popcount64(M[w] & ((uint64_t(1) << (k & 63)) - 1));
+    }
+
+    // 第 j 个（从 0 起）置位的下标；j 越界返回 -1。满足 rank(select(j)) == j
+    Rank select(Rank j) {
+        if (j < 0 || j >= _sz) return -1;
+        buildRankIndex();
+        Rank s = j / SELECT_SAMPLE;
+        Rank lo = selectHint[s];
+        Rank hi = s + 1 < Rank(selectHint.size()) ? selectHint[s + 1] + 1 : Rank(rankIndex.size() / 2);
+        while (hi - lo > 1) {  // 最后一个块前缀 <= j 的块
+            Rank mid = lo + (hi - lo) / 2;
+            if (Rank(rankIndex[2 * mid]) <= j) lo = mid;
+            else hi = mid;
+        }
+        j -= Rank(rankIndex[2 * lo]);
+        uint64_t packed = rankIndex[2 * lo + 1];
+        Rank t = 0, before = 0;
+        for (Rank u = 1; u < RANK_BLOCK_WORDS; u++) {
+            Rank c = Rank((packed >> (9 * (u - 1))) & 0x1FF);
+            if (c > j) break;
+            t = u;
+            before = c;
+        }
+        Rank w = lo * RANK_BLOCK_WORDS + t;
+        return (w << 6) + selectInWord(M[w], j - before);
     }
 };
 
-struct BinNode {
-    char ch;
-    int freq;
-    BinNode* left;
-    BinNode* right;
-    BinNode(char c = 0, int f = 0) : ch(c), freq(f), left(nullptr), right(nullptr) {}
+inline Bitmap operator&(Bitmap A, const Bitmap& B) { return A &= B; }
+inline Bitmap operator|(Bitmap A, const Bitmap& B) { return A |= B; }
+inline Bitmap operator^(Bitmap A, const Bitmap& B) { return A ^= B; }
+
+// ====================== 压缩位图（Roaring） ======================
+// 32 位键按高 16 位分桶，每桶一个容器，按内容选最省的表示：
+//   数组：升序 uint16，基数不超过 ROARING_ARRAY_MAX；
+//   位集：1024 个字共 65536 位，基数更大时使用；
+//   游程：若干 [start, start + length] 区间，由 runOptimize() 在更省时选用。
+// 非游程容器始终满足“基数 <= 4096 即数组”，与可移植序列化格式的约定一致
+#define ROARING_ARRAY_MAX 4096
+#define ROARING_BITSET_WORDS 1024
+#define ROARING_COOKIE_NO_RUN 12346  // 可移植格式的两种文件头
+#define ROARING_COOKIE 12347
+#define ROARING_NO_OFFSET_THRESHOLD 4
+#define ROARING_RUN_MERGE_MAX 1024  // 不超过此基数的数组直接并入游程容器
+
+struct RoaringRun {
+    uint16_t start, length;  // 覆盖 [start, start + length]
 };
 
-struct Compare {
-    bool operator()(BinNode* a, BinNode* b) {
-        return a->freq > b->freq;
-    }
+struct RoaringContainer {
+    enum Type { ARRAY, BITSET, RUN };
+    Type type;
+    int card;
+    vector<uint16_t> values;  // ARRAY
+    vector<uint64_t> words;   // BITSET
+    vector<RoaringRun> runs;  // RUN：升序，互不重叠也不相邻
+    RoaringContainer() : type(ARRAY), card(0) {}
 };
 
-class HuffTree {
+// 置位 [lo, hi]（含两端）
+void setBitRange(uint64_t* words, int lo, int hi) {
+    int wl = lo >> 6, wh = hi >> 6;
+    uint64_t first = ~uint64_t(0) << (lo & 63), last = ~uint64_t(0) >> (63 - (hi & 63));
+    if (wl == wh) {
+        words[wl] |= first & last;
+        return;
+    }
+    words[wl] |= first;
+    for (int w = wl + 1; w < wh; w++) words[w] = ~uint64_t(0);
+    words[wh] |= last;
+}
+
+template <class Visit>
+void containerForEach(const RoaringContainer& c, Visit visit) {
+    if (c.type == RoaringContainer::ARRAY) {
+        for (uint16_t v : c.values) visit(v);
+    } else if (c.type == RoaringContainer::BITSET) {
+        for (int w = 0; w < ROARING_BITSET_WORDS; w++)
+            for (uint64_t bits = c.words[w]; bits; bits &= bits - 1) visit((w << 6) + ctz64(bits));
+    } else {
+        for (const RoaringRun& r : c.runs)
+            for (int v = r.start; v <= r.start + r.length; v++) visit(v);
+    }
+}
+
+bool containerContains(const RoaringContainer& c, uint16_t v) {
+    if (c.type == RoaringContainer::ARRAY) return binary_search(c.values.begin(), c.values.end(), v);
+    if (c.type == RoaringContainer::BITSET) return (c.words[v >> 6] >> (v & 63)) & 1;
+    // 最后一个 start <= v 的区间
+    auto it = upper_bound(c.runs.begin(), c.runs.end(), v,
+                          [](uint16_t x, const RoaringRun& r) { return x < r.start; });
+    return it != c.runs.begin() && v <= (it - 1)->start + (it - 1)->length;
+}
+
+// 游程容器展开为数组或位集
+void containerUnrun(RoaringContainer& c) {
+    if (c.type != RoaringContainer::RUN) return;
+    if (c.card <= ROARING_ARRAY_MAX) {
+        c.values.clear();
+        c.values.reserve(c.card);
+        containerForEach(c, [&](int v) { c.values.push_back(uint16_t(v)); });
+        c.type = RoaringContainer::ARRAY;
+    } else {
+        c.words.assign(ROARING_BITSET_WORDS, 0);
+        for (const RoaringRun& r : c.runs) setBitRange(c.words.data(), r.start, r.start + r.length);
+        c.type = RoaringContainer::BITSET;
+    }
+    vector<RoaringRun>().swap(c.runs);
+}
+
+// 非游程容器按基数在数组与位集之间切换
+void containerNormalize(RoaringContainer& c) {
+    if (c.type == RoaringContainer::BITSET && c.card <= ROARING_ARRAY_MAX) {
+        c.values.clear();
+        c.values.reserve(c.card);
+        containerForEach(c, [&](int v) { c.values.push_back(uint16_t(v)); });
+        vector<uint64_t>().swap(c.words);
+        c.type = RoaringContainer::ARRAY;
+    } else if (c.type == RoaringContainer::ARRAY && c.card > ROARING_ARRAY_MAX) {
+        c.words.assign(ROARING_BITSET_WORDS, 0);
+        for (uint16_t v : c.values) c.words[v >> 6] |= uint64_t(1) << (v & 63);
+        vector<uint16_t>().swap(c.values);
+        c.type = RoaringContainer::BITSET;
+    }
+}
+
+void containerAdd(RoaringContainer& c, uint16_t v) {
+    if (c.type == RoaringContainer::ARRAY) {
+        if (c.values.empty() || v > c.values.back()) {  // 顺序插入走快路径
+            c.values.push_back(v);
+        } else {
+            auto it = lower_bound(c.values.begin(), c.values.end(), v);
+            if (*it == v) return;
+            c.values.insert(it, v);
+        }
+        c.card++;
+        containerNormalize(c);
+    } else if (c.type == RoaringContainer::BITSET) {
+        uint64_t bit = uint64_t(1) << (v & 63);
+        if (c.words[v >> 6] & bit) return;
+        c.words[v >> 6] |= bit;
+        c.card++;
+    } else {
+        auto it = upper_bound(c.runs.begin(), c.runs.end(), v,
+                              [](uint16_t x, const RoaringRun& r) { return x < r.start; });
+        if (it != c.runs.begin()) {
+            RoaringRun& prev = *(it - 1);
+            int end = prev.start + prev.length;
+            if (v <= end) return;
+            if (v == end + 1) {  // 接在前一区间末尾，可能与后一区间相连
+                prev.length++;
+                if (it != c.runs.end() && it->start == v + 1) {
+                    prev.length = uint16_t(prev.length + it->length + 1);
+                    c.runs.erase(it);
+                }
+                c.card++;
+                return;
+            }
+        }
+        if (it != c.runs.end() && it->start == v + 1) {
+            it->start = v;
+            it->length++;
+        } else {
+            RoaringRun r = {v, 0};
+            c.runs.insert(it, r);
+        }
+        c.card++;
+    }
+}
+
+// 游程容器只裁剪或拆分命中的区间；拆分后游程表示不再更省时才展开
+void containerRemove(RoaringContainer& c, uint16_t v) {
+    if (!containerContains(c, v)) return;
+    if (c.type == RoaringContainer::RUN) {
+        auto it = upper_bound(c.runs.begin(), c.runs.end(), v,
+                              [](uint16_t x, const RoaringRun& r) { return x < r.start; }) - 1;
+        int end = it->start + it->length;
+        if (it->length == 0) {
+            c.runs.erase(it);
+        } else if (v == it->start) {
+            it->start++;
+            it->length--;
+        } else if (v == end) {
+            it->length--;
+        } else {
+            RoaringRun tail = {uint16_t(v + 1), uint16_t(end - v - 1)};
+            it->length = uint16_t(v - it->start - 1);
+            c.runs.insert(it + 1, tail);
+        }
+        c.card--;
+        size_t flatBytes = c.card <= ROARING_ARRAY_MAX ? 2 * size_t(c.card) : 8 * ROARING_BITSET_WORDS;
+        if (2 + 4 * c.runs.size() > flatBytes) containerUnrun(c);
+        return;
+    }
+    if (c.type == RoaringContainer::ARRAY) {
+        c.values.erase(lower_bound(c.values.begin(), c.values.end(), v));
+    } else {
+        c.words[v >> 6] &= ~(uint64_t(1) << (v & 63));
+    }
+    c.card--;
+    containerNormalize(c);
+}
+
+int containerRunCount(const RoaringContainer& c) {
+    if (c.type == RoaringContainer::RUN) return int(c.runs.size());
+    int n = 0;
+    if (c.type == RoaringContainer::ARRAY) {
+        for (size_t i = 0; i < c.values.size(); i++) n += i == 0 || c.values[i] != c.values[i - 1] + 1;
+    } else {
+        uint64_t carry = 0;  // 前一字的最高位
+        for (int w = 0; w < ROARING_BITSET_WORDS; w++) {
+            uint64_t x = c.words[w];
+            n += popcount64(x & ~((x << 1) | carry));
+            carry = x >> 63;
+        }
+    }
+    return n;
+}
+
+// 序列化后的字节数（不含文件头）
+size_t containerSerializedBytes(const RoaringContainer& c) {
+    if (c.type == RoaringContainer::RUN) return 2 + 4 * c.runs.size();
+    return c.type == RoaringContainer::ARRAY ? 2 * size_t(c.card) : 8 * ROARING_BITSET_WORDS;
+}
+
+// 游程表示更省时转为游程，否则展开
+void containerRunOptimize(RoaringContainer& c) {
+    size_t runBytes = 2 + 4 * size_t(containerRunCount(c));
+    size_t flatBytes = c.card <= ROARING_ARRAY_MAX ? 2 * size_t(c.card) : 8 * ROARING_BITSET_WORDS;
+    if (runBytes >= flatBytes) {
+        containerUnrun(c);
+        return;
+    }
+    if (c.type == RoaringContainer::RUN) return;
+    vector<RoaringRun> runs;
+    containerForEach(c, [&](int v) {
+        if (!runs.empty() && runs.back().start + runs.back().length + 1 == v) {
+            runs.back().length++;
+        } else {
+            RoaringRun r = {uint16_t(v), 0};
+            runs.push_back(r);
+        }
+    });
+    c.runs.swap(runs);
+    vector<uint16_t>().swap(c.values);
+    vector<uint64_t>().swap(c.words);
+    c.type = RoaringContainer::RUN;
+}
+
+// ---------- 容器间集合运算 ----------
+enum RoaringOp { ROARING_AND, ROARING_OR, ROARING_XOR, ROARING_ANDNOT };
+
+// 两个位集逐字运算（复用 Bitmap 的 SIMD 内核）
+template <class Op>
+static RoaringContainer bitsetOp(RoaringContainer a, const RoaringContainer& b) {
+    combineWords<Op>(a.words.data(), b.words.data(), ROARING_BITSET_WORDS);
+    a.card = popcountWords(a.words.data(), ROARING_BITSET_WORDS);
+    containerNormalize(a);
+    return a;
+}
+
+// 从 first 起按 1、2、4…… 的步长向后试探，找到包含 v 的区间后再在其中二分；
+// 相邻两次查找位置接近时只需 O(log 距离) 次比较
+static vector<uint16_t>::const_iterator gallopLowerBound(vector<uint16_t>::const_iterator first,
+                                                         vector<uint16_t>::const_iterator last, uint16_t v) {
+    size_t lo = 0, step = 1, n = size_t(last - first);
+    while (step < n && first[step] < v) {
+        lo = step;
+        step *= 2;
+    }
+    return lower_bound(first + lo, first + min(step + 1, n), v);
+}
+
+static RoaringContainer arrayOp(const RoaringContainer& a, const RoaringContainer& b, RoaringOp op) {
+    RoaringContainer r;
+    vector<uint16_t>& out = r.values;
+    const vector<uint16_t>&x = a.values, &y = b.values;
+    if (op == ROARING_AND && (x.size() * 64 < y.size() || y.size() * 64 < x.size())) {
+        // 规模悬殊时，对小数组的每个元素在大数组中从上次位置起跳跃查找
+        const vector<uint16_t>& small = x.size() < y.size() ? x : y;
+        const vector<uint16_t>& large = x.size() < y.size() ? y : x;
+        auto from = large.begin();
+        for (uint16_t v : small) {
+            from = gallopLowerBound(from, large.end(), v);
+            if (from == large.end()) break;
+            if (*from == v) out.push_back(v);
+        }
+    } else if (op == ROARING_AND) {
+        set_intersection(x.begin(), x.end(), y.begin(), y.end(), back_inserter(out));
+    } else if (op == ROARING_OR) {
+        set_union(x.begin(), x.end(), y.begin(), y.end(), back_inserter(out));
+    } else if (op == ROARING_XOR) {
+        set_symmetric_difference(x.begin(), x.end(), y.begin(), y.end(), back_inserter(out));
+    } else {
+        set_difference(x.begin(), x.end(), y.begin(), y.end(), back_inserter(out));
+    }
+    r.card = int(out.size());
+    containerNormalize(r);
+    return r;
+}
+
+// 数组与位集：AND / ANDNOT 只需按数组过滤，OR / XOR 在位集副本上逐个改位
+static RoaringContainer arrayBitsetOp(const RoaringContainer& arr, const RoaringContainer& bits, RoaringOp op,
+                                      bool arrayFirst) {
+    RoaringContainer r;
+    if (op == ROARING_AND || (op == ROARING_ANDNOT && arrayFirst)) {
+        bool keep = op == ROARING_AND;
+        for (uint16_t v : arr.values)
+            if (bool((bits.words[v >> 6] >> (v & 63)) & 1) == keep) r.values.push_back(v);
+        r.card = int(r.values.size());
+        return r;
+    }
+    r = bits;
+    for (uint16_t v : arr.values) {
+        uint64_t bit = uint64_t(1) << (v & 63);
+        if (op == ROARING_OR) r.words[v >> 6] |= bit;
+        else if (op == ROARING_XOR) r.words[v >> 6] ^= bit;
+        else r.words[v >> 6] &= ~bit;
+    }
+    r.card = popcountWords(r.words.data(), ROARING_BITSET_WORDS);
+    containerNormalize(r);
+    return r;
+}
+
+// 两个游程容器的交与并：区间双指针归并
+static RoaringContainer runOp(const RoaringContainer& a, const RoaringContainer& b, RoaringOp op) {
+    RoaringContainer r;
+    r.type = RoaringContainer::RUN;
+    size_t i = 0, j = 0;
+    if (op == ROARING_AND) {
+        while (i < a.runs.size() && j < b.runs.size()) {
+            int as = a.runs[i].start, ae = as + a.runs[i].length;
+            int bs = b.runs[j].start, be = bs + b.runs[j].length;
+            int lo = max(as, bs), hi = min(ae, be);
+            if (lo <= hi) {
+                RoaringRun run = {uint16_t(lo), uint16_t(hi - lo)};
+                r.runs.push_back(run);
+            }
+            if (ae < be) i++;
+            else j++;
+        }
+    } else {
+        while (i < a.runs.size() || j < b.runs.size()) {
+            const RoaringRun& next = j == b.runs.size() || (i < a.runs.size() && a.runs[i].start < b.runs[j].start)
+                                         ? a.runs[i++] : b.runs[j++];
+            if (!r.runs.empty() && next.start <= r.runs.back().start + r.runs.back().length + 1) {
+                int end = max(r.runs.back().start + r.runs.back().length, next.start + next.length);
+                r.runs.back().length = uint16_t(end - r.runs.back().start);
+            } else {
+                r.runs.push_back(next);
+            }
+        }
+    }
+    for (const RoaringRun& run : r.runs) r.card += run.length + 1;
+    containerRunOptimize(r);
+    return r;
+}
+
+RoaringContainer containerOp(const RoaringContainer& a, const RoaringContainer& b, RoaringOp op) {
+    typedef RoaringContainer C;
+    const int full = 1 << 16;
+    if (op == ROARING_AND && a.card == full) return b;  // 满容器的快路径
+    if (op == ROARING_AND && b.card == full) return a;
+    if (op == ROARING_OR && (a.card == full || b.card == full)) return a.card == full ? a : b;
+    if (a.type == C::RUN && b.type == C::RUN && (op == ROARING_AND || op == ROARING_OR)) return runOp(a, b, op);
+    if ((a.type == C::RUN && b.type == C::ARRAY) || (a.type == C::ARRAY && b.type == C::RUN)) {
+        // 数组一侧只需逐个查询游程区间；小数组并入游程时也不必展开
+        const C& arr = a.type == C::ARRAY ? a : b;
+        const C& run = a.type == C::RUN ? a : b;
+        if (op == ROARING_AND || (op == ROARING_ANDNOT && &arr == &a)) {
+            C r;
+            for (uint16_t v : arr.values)
+                if (containerContains(run, v) == (op == ROARING_AND)) r.values.push_back(v);
+            r.card = int(r.values.size());
+            return r;
+        }
+        if (op == ROARING_OR && arr.card <= ROARING_RUN_MERGE_MAX) {
+            C r = run;
+            for (uint16_t v : arr.values) containerAdd(r, v);
+            containerRunOptimize(r);
+            return r;
+        }
+    }
+    if (a.type == C::RUN || b.type == C::RUN) {
+        C x = a, y = b;
+        containerUnrun(x);
+        containerUnrun(y);
+        return containerOp(x, y, op);
+    }
+    if (a.type == C::ARRAY && b.type == C::ARRAY) return arrayOp(a, b, op);
+    if (a.type == C::ARRAY) return arrayBitsetOp(a, b, op, true);
+    if (b.type == C::ARRAY) return arrayBitsetOp(b, a, op, false);
+    switch (op) {
+    case ROARING_AND: return bitsetOp<WordAnd>(a, b);
+    case ROARING_OR: return bitsetOp<WordOr>(a, b);
+    case ROARING_XOR: return bitsetOp<WordXor>(a, b);
+    default: return bitsetOp<WordAndNot>(a, b);
+    }
+}
+
+// ---------- 可移植序列化（与 CRoaring / Java RoaringBitmap 的格式相同，小端） ----------
+static void putU16(vector<unsigned char>& out, uint32_t v) {
+    out.push_back((unsigned char)(v & 0xFF));
+    out.push_back((unsigned char)(v >> 8));
+}
+static void putU32(vector<unsigned char>& out, uint32_t v) {
+    putU16(out, v & 0xFFFF);
+    putU16(out, v >> 16);
+}
+static uint32_t getU16(const unsigned char* p) { return uint32_t(p[0]) | uint32_t(p[1]) << 8; }
+static uint32_t getU32(const unsigned char* p) { return getU16(p) | getU16(p + 2) << 16; }
+
+class RoaringBitmap {
 private:
-    BinNode* root;
-    map<char, string> codeMap;
+    vector<uint16_t> keys;  // 升序
+    vector<RoaringContainer> containers;
 
-    void buildCodeMap(BinNode* node, string code) {
-        if (!node) return;
-        if (node->ch != 0) {
-            codeMap[node->ch] = code;
-            return;
+    size_t lowerKey(uint16_t key) const { return lower_bound(keys.begin(), keys.end(), key) - keys.begin(); }
+
+    RoaringContainer& containerFor(uint16_t key) {
+        if (keys.empty() || key > keys.back()) {  // 顺序插入走快路径
+            keys.push_back(key);
+            containers.push_back(RoaringContainer());
+            return containers.back();
+        }
+        size_t i = lowerKey(key);
+        if (keys[i] != key) {
+            keys.insert(keys.begin() + i, key);
+            containers.insert(containers.begin() + i, RoaringContainer());
         }
-        buildCodeMap(node->left, code + "0");
-        buildCodeMap(node->right, code + "1");
+        return containers[i];
+    }
+
+    void append(uint16_t key, const RoaringContainer& c) {
+        if (c.card == 0) return;
+        keys.push_back(key);
+        containers.push_back(c);
     }
 
 public:
-    HuffTree(const string& text) : root(nullptr) {
-        int freq[26] = {0};
-        for (char c : text) {
-            if (isalpha(c)) {
-                c = tolower(c);
-                freq[c - 'a']++;
-            }
+    void add(uint32_t x) { containerAdd(containerFor(uint16_t(x >> 16)), uint16_t(x & 0xFFFF)); }
+
+    // 加入 [lo, hi)；整桶覆盖时直接生成单区间游程容器
+    void addRange(uint64_t lo, uint64_t hi) {
+        hi = min(hi, uint64_t(1) << 32);
+        while (lo < hi) {
+            uint16_t key = uint16_t(lo >> 16);
+            uint64_t end = min(hi, (uint64_t(key) + 1) << 16);
+            RoaringContainer run;
+            run.type = RoaringContainer::RUN;
+            RoaringRun r = {uint16_t(lo & 0xFFFF), uint16_t(end - lo - 1)};
+            run.runs.push_back(r);
+            run.card = int(end - lo);
+            RoaringContainer& c = containerFor(key);
+            c = c.card ? containerOp(c, run, ROARING_OR) : run;
+            lo = end;
         }
+    }
 
-        priority_queue<BinNode*, vector<BinNode*>, Compare> pq;
-        for (int i = 0; i < 26; ++i) {
-            if (freq[i] > 0) {
-                pq.push(new BinNode('a' + i, freq[i]));
+    void remove(uint32_t x) {
+        uint16_t key = uint16_t(x >> 16);
+        size_t i = lowerKey(key);
+        if (i == keys.size() || keys[i] != key) return;
+        containerRemove(containers[i], uint16_t(x & 0xFFFF));
+        if (containers[i].card == 0) {
+            keys.erase(keys.begin() + i);
+            containers.erase(containers.begin() + i);
+        }
+    }
+
+    bool contains(uint32_t x) const {
+        uint16_t key = uint16_t(x >> 16);
+        size_t i = lowerKey(key);
+        return i < keys.size() && keys[i] == key && containerContains(containers[i], uint16_t(x & 0xFFFF));
+    }
+
+    uint64_t cardinality() const {
+        uint64_t n = 0;
+        for (const RoaringContainer& c : containers) n += c.card;
+        return n;
+    }
+    size_t containerCount() const { return containers.size(); }
+
+    // 内存占用估计：键数组加各容器载荷
+    size_t sizeInBytes() const {
+        size_t bytes = keys.capacity() * sizeof(uint16_t) + containers.capacity() * sizeof(RoaringContainer);
+        for (const RoaringContainer& c : containers)
+            bytes += c.values.capacity() * sizeof(uint16_t) + c.words.capacity() * sizeof(uint64_t) +
+                     c.runs.capacity() * sizeof(RoaringRun);
+        return bytes;
+    }
+
+    // 按升序访问每个元素
+    template <class Visit>
+    void forEach(Visit visit) const {
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint32_t high = uint32_t(keys[i]) << 16;
+            containerForEach(containers[i], [&](int v) { visit(high | uint32_t(v)); });
+        }
+    }
+
+    // 选用更省的容器表示，并释放批量插入留下的多余容量
+    void runOptimize() {
+        for (RoaringContainer& c : containers) {
+            containerRunOptimize(c);
+            c.values.shrink_to_fit();
+            c.runs.shrink_to_fit();
+        }
+        keys.shrink_to_fit();
+        containers.shrink_to_fit();
+    }
+
+    static RoaringBitmap fromBitmap(const Bitmap& bmp) {
+        RoaringBitmap r;
+        bmp.forEach([&](Rank k) { r.add(uint32_t(k)); });
+        r.runOptimize();
+        return r;
+    }
+
+    // 按键归并：AND 只处理两边共有的键，OR / XOR 保留两边独有的，ANDNOT 只保留左边独有的
+    static RoaringBitmap combine(const RoaringBitmap& a, const RoaringBitmap& b, RoaringOp op) {
+        RoaringBitmap r;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() || j < b.keys.size()) {
+            if (j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j])) {
+                if (op != ROARING_AND) r.append(a.keys[i], a.containers[i]);
+                i++;
+            } else if (i == a.keys.size() || b.keys[j] < a.keys[i]) {
+                if (op == ROARING_OR || op == ROARING_XOR) r.append(b.keys[j], b.containers[j]);
+                j++;
+            } else {
+                r.append(a.keys[i], containerOp(a.containers[i], b.containers[j], op));
+                i++, j++;
             }
         }
+        return r;
+    }
 
-        if (pq.empty()) {
-            root = nullptr;
-            return;
+    void serialize(vector<unsigned char>& out) const {
+        size_t n = keys.size(), start = out.size();
+        bool hasRun = false;
+        for (const RoaringContainer& c : containers) hasRun = hasRun || c.type == RoaringContainer::RUN;
+        if (hasRun) {
+            putU32(out, ROARING_COOKIE | uint32_t(n - 1) << 16);
+            size_t flags = out.size();
+            out.resize(flags + (n + 7) / 8, 0);
+            for (size_t i = 0; i < n; i++)
+                if (containers[i].type == RoaringContainer::RUN) out[flags + i / 8] |= (unsigned char)(1 << (i % 8));
+        } else {
+            putU32(out, ROARING_COOKIE_NO_RUN);
+            putU32(out, uint32_t(n));
+        }
+        for (size_t i = 0; i < n; i++) {
+            putU16(out, keys[i]);
+            putU16(out, uint32_t(containers[i].card - 1));
         }
+        if (!hasRun || n >= ROARING_NO_OFFSET_THRESHOLD) {
+            uint32_t offset = uint32_t(out.size() - start + 4 * n);
+            for (size_t i = 0; i < n; i++) {
+                putU32(out, offset);
+                offset += uint32_t(containerSerializedBytes(containers[i]));
+            }
+        }
+        for (const RoaringContainer& c : containers) {
+            if (c.type == RoaringContainer::RUN) {
+                putU16(out, uint32_t(c.runs.size()));
+                for (const RoaringRun& r : c.runs) putU16(out, r.start), putU16(out, r.length);
+            } else if (c.type == RoaringContainer::ARRAY) {
+                for (uint16_t v : c.values) putU16(out, v);
+            } else {
+                for (uint64_t w : c.words) putU32(out, uint32_t(w)), putU32(out, uint32_t(w >> 32));
+            }
+        }
+    }
 
-        if (pq.size() == 1) {
-            BinNode* only = pq.top(); pq.pop();
-            root = new BinNode(0, only->freq);
-            root->left = only;
+    // 解析失败（截断、键无序、基数与内容不符等）返回 false，且不改变原内容
+    bool deserialize(const unsigned char* p, size_t len) {
+        RoaringBitmap r;
+        size_t pos = 0, n;
+        bool hasRun;
+        const unsigned char* runFlags = NULL;
+        if (len < 4) return false;
+        uint32_t cookie = getU32(p);
+        if ((cookie & 0xFFFF) == ROARING_COOKIE) {
+            hasRun = true;
+            n = (cookie >> 16) + 1;
+            pos = 4;
+            runFlags = p + pos;
+            pos += (n + 7) / 8;
+        } else if (cookie == ROARING_COOKIE_NO_RUN) {
+            if (len < 8) return false;
+            hasRun = false;
+            n = getU32(p + 4);
+            pos = 8;
+            if (n > 65536) return false;
         } else {
-            while (pq.size() > 1) {
-                BinNode* l = pq.top(); pq.pop();
-                BinNode* r = pq.top(); pq.pop();
-                BinNode* parent = new BinNode(0, l->freq + r->freq);
-                parent->left = l;
-                parent->right = r;
-                pq.push(parent);
+            return false;
+        }
+        if (pos + 4 * n > len) return false;
+        const unsigned char* header = p + pos;
+        pos += 4 * n;
+        if (!hasRun || n >= ROARING_NO_OFFSET_THRESHOLD) pos += 4 * n;  // 顺序读取，偏移表只跳过
+        for (size_t i = 0; i < n; i++) {
+            uint16_t key = uint16_t(getU16(header + 4 * i));
+            int card = int(getU16(header + 4 * i + 2)) + 1;
+            if (i && key <= r.keys.back()) return false;
+            RoaringContainer c;
+            if (hasRun && (runFlags[i / 8] >> (i % 8)) & 1) {
+                if (pos + 2 > len) return false;
+                size_t runs = getU16(p + pos);
+                pos += 2;
+                if (pos + 4 * runs > len) return false;
+                c.type = RoaringContainer::RUN;
+                c.runs.resize(runs);
+                int total = 0;
+                for (size_t k = 0; k < runs; k++, pos += 4) {
+                    c.runs[k].start = uint16_t(getU16(p + pos));
+                    c.runs[k].length = uint16_t(getU16(p + pos + 2));
+                    if (c.runs[k].start + c.runs[k].length > 65535) return false;
+                    if (k && c.runs[k].start <= c.runs[k - 1].start + c.runs[k - 1].length + 1) return false;
+                    total += c.runs[k].length + 1;
+                }
+                if (total != card) return false;
+            } else if (card <= ROARING_ARRAY_MAX) {
+                if (pos + 2 * size_t(card) > len) return false;
+                c.values.resize(card);
+                for (int k = 0; k < card; k++, pos += 2) {
+                    c.values[k] = uint16_t(getU16(p + pos));
+                    if (k && c.values[k] <= c.values[k - 1]) return false;
+                }
+            } else {
+                if (pos + 8 * ROARING_BITSET_WORDS > len) return false;
+                c.type = RoaringContainer::BITSET;
+                c.words.resize(ROARING_BITSET_WORDS);
+                for (int k = 0; k < ROARING_BITSET_WORDS; k++, pos += 8)
+                    c.words[k] = uint64_t(getU32(p + pos)) | uint64_t(getU32(p + pos + 4)) << 32;
+                if (popcountWords(c.words.data(), ROARING_BITSET_WORDS) != card) return false;
+            }
+            c.card = card;
+            r.keys.push_back(key);
+            r.containers.push_back(c);
+        }
+        swap(keys, r.keys);
+        swap(containers, r.containers);
+        return true;
+    }
+
+    bool save(const char* file) const {
+        vector<unsigned char> buf;
+        serialize(buf);
+        FILE* fp = fopen(file, "wb");
+        if (!fp) return false;
+        bool ok = fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+        return fclose(fp) == 0 && ok;
+    }
+
+    bool load(const char* file) {
+        FILE* fp = fopen(file, "rb");
+        if (!fp) return false;
+        vector<unsigned char> buf;
+        unsigned char chunk[65536];
+        size_t got;
+        while ((got = fread(chunk, 1, sizeof(chunk), fp)) > 0) buf.insert(buf.end(), chunk, chunk + got);
+        fclose(fp);
+        return deserialize(buf.data(), buf.size());
+    }
+};
+
+inline RoaringBitmap operator&(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return RoaringBitmap::combine(a, b, ROARING_AND);
+}
+inline RoaringBitmap operator|(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return RoaringBitmap::combine(a, b, ROARING_OR);
+}
+inline RoaringBitmap operator^(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return RoaringBitmap::combine(a, b, ROARING_XOR);
+}
+inline RoaringBitmap andNot(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return RoaringBitmap::combine(a, b, ROARING_ANDNOT);
+}
+
+// ====================== Huffman 编解码 ======================
+// 字母表为全部 256 个字节值。由树只取码长，超过 HUFF_MAX_CODE_BITS 时用包合并重求最优限长码长，
+// 再按码长分配规范码，文件头因此只需存码长。位流低位在前，码字按发送顺序翻转后存放，
+// 写入时直接把码字拼进 64 位缓冲再整字节写出；解码查一张 2^HUFF_MAX_CODE_BITS 项的表，
+// 每次查表至少解出一个、最多 HUFF_TABLE_SYMS 个符号
+#define HUFF_SYMBOLS 256
+#define HUFF_MAX_CODE_BITS 12
+#define HUFF_TABLE_SYMS 3
+#define HUFF_MAGIC "HUF2"
+
+inline uint64_t loadLE64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+inline void storeLE64(unsigned char* p, uint64_t v) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    memcpy(p, &v, 8);
+}
+
+// 低位在前的位流写入。out 由调用方分配，末尾至少留 8 字节余量
+struct BitWriter {
+    unsigned char* out;
+    size_t pos;    // 已完整写出的字节数
+    uint64_t acc;  // 尚未写满一个字节的尾部，n < 8
+    int n;
+    explicit BitWriter(unsigned char* buf) : out(buf), pos(0), acc(0), n(0) {}
+    // len <= HUFF_MAX_CODE_BITS；每次把整个缓冲写出去，再前移整字节数
+    void put(uint64_t code, int len) {
+        acc |= code << n;
+        n += len;
+        storeLE64(out + pos, acc);
+        int bytes = n >> 3;
+        pos += bytes;
+        acc = bytes ? acc >> (bytes * 8) : acc;
+        n &= 7;
+    }
+    // 补齐最后一个字节，返回总字节数
+    size_t finish() { return pos + (n > 0); }
+};
+
+// 低位在前的位流读取状态：acc 中有 n 个未用的位，下一个要装入的字节是 in[pos]。
+// 补充和取位都在 HuffDecoder::decode 里用局部变量完成，解码结束时写回
+struct BitReader {
+    const unsigned char* in;
+    size_t size, pos;
+    uint64_t acc;
+    int n;
+    BitReader(const unsigned char* buf, size_t len) : in(buf), size(len), pos(0), acc(0), n(0) {}
+};
+
+// 结点存放在 HuffTree 内的定长数组里，用 16 位下标互指：建树不做任何堆分配，树随 HuffTree 一起释放
+#define HUFF_MAX_NODES (2 * HUFF_SYMBOLS - 1)
+#define HUFF_NIL 0xFFFF
+struct BinNode {
+    uint64_t freq;
+    uint16_t left, right;  // 叶子为 HUFF_NIL
+    unsigned char ch;
+};
+
+struct HuffCode {
+    uint64_t bits;  // 按发送顺序存放：第 i 位是第 i 个发出的位
+    int len;        // 0 表示该字节未出现
+};
+
+inline uint64_t reverseBits(uint64_t v, int len) {
+    uint64_t r = 0;
+    for (int i = 0; i < len; i++, v >>= 1) r = (r << 1) | (v & 1);
+    return r;
+}
+
+// 按码长分配规范码：码长短的在前，同长按字节值递增（先发高位）。
+// 码长超过上限或不满足 Kraft 不等式时返回 false；只有一个符号时码不完整，也算合法
+bool canonicalCodes(const unsigned char len[HUFF_SYMBOLS], HuffCode codes[HUFF_SYMBOLS]) {
+    int count[HUFF_MAX_CODE_BITS + 1] = {0};
+    for (int c = 0; c < HUFF_SYMBOLS; c++) {
+        if (len[c] > HUFF_MAX_CODE_BITS) return false;
+        count[len[c]]++;
+    }
+    uint32_t kraft = 0, next[HUFF_MAX_CODE_BITS + 1] = {0}, code = 0;
+    for (int l = 1; l <= HUFF_MAX_CODE_BITS; l++) {
+        kraft += uint32_t(count[l]) << (HUFF_MAX_CODE_BITS - l);
+        code = (code + count[l - 1] * (l > 1)) << 1;
+        next[l] = code;
+    }
+    if (kraft > (1u << HUFF_MAX_CODE_BITS)) return false;
+    for (int c = 0; c < HUFF_SYMBOLS; c++) {
+        codes[c].len = len[c];
+        codes[c].bits = len[c] ? reverseBits(next[len[c]]++, len[c]) : 0;
+    }
+    return true;
+}
+
+// 包合并（package-merge）求最长不超过 limit 位的最优码长；出现的符号数 n 需满足 2 <= n <= 2^limit。
+// 每轮把上一轮的列表两两打包再与叶子归并，取最后列表的前 2n-2 项，符号出现几次码长就是几
+void packageMerge(const uint64_t freq[HUFF_SYMBOLS], int limit, unsigned char len[HUFF_SYMBOLS]) {
+    struct Item {
+        uint64_t weight;
+        vector<unsigned char> syms;  // 所含叶子，可重复
+    };
+    vector<Item> leaves;
+    for (int c = 0; c < HUFF_SYMBOLS; c++)
+        if (freq[c]) leaves.push_back(Item{freq[c], vector<unsigned char>(1, (unsigned char)c)});
+    stable_sort(leaves.begin(), leaves.end(), [](const Item& a, const Item& b) { return a.weight < b.weight; });
+    vector<Item> list = leaves;
+    for (int level = 1; level < limit; level++) {
+        vector<Item> packages, merged;
+        for (size_t k = 0; k + 1 < list.size(); k += 2) {
+            Item pk = {list[k].weight + list[k + 1].weight, list[k].syms};
+            pk.syms.insert(pk.syms.end(), list[k + 1].syms.begin(), list[k + 1].syms.end());
+            packages.push_back(pk);
+        }
+        size_t i = 0, p = 0;
+        while (i < leaves.size() || p < packages.size()) {
+            if (p == packages.size() || (i < leaves.size() && leaves[i].weight <= packages[p].weight)) merged.push_back(leaves[i++]);
+            else merged.push_back(packages[p++]);
+        }
+        list.swap(merged);
+    }
+    memset(len, 0, HUFF_SYMBOLS);
+    for (size_t k = 0; k + 2 < 2 * leaves.size(); k++)
+        for (unsigned char c : list[k].syms) len[c]++;
+}
+
+class HuffTree {
+private:
+    BinNode nodes[HUFF_MAX_NODES];  // 前 leaves 个为叶子，之后按创建次序排列内部结点，根在最后
+    int count;
+    unsigned char lengths[HUFF_SYMBOLS];
+    HuffCode codes[HUFF_SYMBOLS];
+
+    // 双队列建树：叶子按 (频率, 字节值) 升序排好，新建内部结点的频率单调不减，
+    // 每步从两个队列的队头取较小者（相等时先取叶子），O(n) 完成。
+    // 频率已有序时跳过排序；结果与按 (频率, 创建次序) 出队的优先队列相同
+    void build(const uint64_t freq[HUFF_SYMBOLS]) {
+        memset(lengths, 0, sizeof(lengths));
+        int leaves = 0;
+        for (int c = 0; c < HUFF_SYMBOLS; c++) {
+            if (!freq[c]) continue;
+            BinNode& leaf = nodes[leaves++];
+            leaf.freq = freq[c];
+            leaf.left = leaf.right = HUFF_NIL;
+            leaf.ch = (unsigned char)c;
+        }
+        count = leaves;
+        auto less = [](const BinNode& a, const BinNode& b) { return a.freq != b.freq ? a.freq < b.freq : a.ch < b.ch; };
+        if (!is_sorted(nodes, nodes + leaves, less)) sort(nodes, nodes + leaves, less);
+
+        if (leaves == 1) lengths[nodes[0].ch] = 1;
+        if (leaves > 1) {
+            int leaf = 0, inner = leaves;
+            auto pop = [&]() {
+                return inner == count || (leaf < leaves && nodes[leaf].freq <= nodes[inner].freq) ? leaf++ : inner++;
+            };
+            while (count < 2 * leaves - 1) {
+                int l = pop(), r = pop();
+                BinNode& parent = nodes[count++];
+                parent.freq = nodes[l].freq + nodes[r].freq;
+                parent.left = uint16_t(l);
+                parent.right = uint16_t(r);
+                parent.ch = 0;
             }
-            root = pq.top();
+            // 父结点下标总大于子结点，从根往下扫一遍即得各叶子深度（最多 255）
+            unsigned char depth[HUFF_MAX_NODES];
+            depth[count - 1] = 0;
+            for (int i = count - 1; i >= leaves; i--) depth[nodes[i].left] = depth[nodes[i].right] = depth[i] + 1;
+            bool tooDeep = false;
+            for (int i = 0; i < leaves; i++) {
+                lengths[nodes[i].ch] = depth[i];
+                tooDeep = tooDeep || depth[i] > HUFF_MAX_CODE_BITS;
+            }
+            if (tooDeep) packageMerge(freq, HUFF_MAX_CODE_BITS, lengths);
         }
+        canonicalCodes(lengths, codes);
+    }
+
+public:
+    HuffTree(const string& text) : count(0) {
+        uint64_t freq[HUFF_SYMBOLS] = {0};
+        for (unsigned char c : text) freq[c]++;
+        build(freq);
+    }
+
+    HuffTree(const uint64_t freq[HUFF_SYMBOLS]) : count(0) { build(freq); }
 
-        buildCodeMap(root, "");
+    const HuffCode& code(unsigned char c) const { return codes[c]; }
+    const unsigned char* codeLengths() const { return lengths; }
+
+    // 按给定频率编码后的总位数
+    uint64_t encodedBits(const uint64_t freq[HUFF_SYMBOLS]) const {
+        uint64_t bits = 0;
+        for (int c = 0; c < HUFF_SYMBOLS; c++) bits += freq[c] * uint64_t(codes[c].len);
+        return bits;
+    }
+
+    // 编码 data[0, n)；每个字节都必须在建树的频率中出现过
+    void encode(const unsigned char* data, size_t n, BitWriter& w) const {
+        for (size_t i = 0; i < n; i++) w.put(codes[data[i]].bits, codes[data[i]].len);
     }
 
+    // 以 '0'/'1' 字符串给出编码结果，供演示打印
     string encode(const string& word) {
         string result = "";
-        for (char c : word) {
-            if (isalpha(c)) {
-                c = tolower(c);
-                if (codeMap.find(c) != codeMap.end()) {
-                    result += codeMap[c];
-                } else {
-                    cerr << "Warning: '" << c << "' not in code map.\n";
-                }
+        for (unsigned char c : word) {
+            if (codes[c].len == 0) {
+                cerr << "Warning: '" << c << "' not in code map.\n";
+                continue;
             }
+            for (int i = 0; i < codes[c].len; i++) result += ((codes[c].bits >> i) & 1) ? '1' : '0';
         }
         return result;
     }
 
     void printCodes() {
         cout << "Huffman Codes:\n";
-        for (auto& p : codeMap) {
-            cout << p.first << ": " << p.second << "\n";
+        for (int c = 0; c < HUFF_SYMBOLS; c++) {
+            if (codes[c].len == 0) continue;
+            if (c == ' ') cout << "' '";
+            else if (isprint(c)) cout << char(c);
+            else cout << "\\x" << hex << setw(2) << setfill('0') << c << dec << setfill(' ');
+            cout << ": " << encode(string(1, char(c))) << "\n";
         }
         cout << "\n";
     }
 };
 
-int main() {
+// 查表解码器：表项低 24 位依次放最多 3 个符号，24-25 位为符号数（0 表示无效码），26-29 位为消耗的位数
+class HuffDecoder {
+private:
+    uint32_t table[1 << HUFF_MAX_CODE_BITS];
+    unsigned char lengths[HUFF_SYMBOLS];
+
+public:
+    // 码长不合法时返回 false
+    bool init(const unsigned char len[HUFF_SYMBOLS]) {
+        const int B = HUFF_MAX_CODE_BITS;
+        HuffCode codes[HUFF_SYMBOLS];
+        if (!canonicalCodes(len, codes)) return false;
+        memcpy(lengths, len, HUFF_SYMBOLS);
+        // 先建单符号表：低 8 位符号、其上码长，码长 0 为无效
+        vector<uint32_t> single(1 << B, 0);
+        for (int c = 0; c < HUFF_SYMBOLS; c++)
+            for (uint32_t k = uint32_t(codes[c].bits); len[c] && k < (1u << B); k += 1u << len[c])
+                single[k] = uint32_t(c) | uint32_t(len[c]) << 8;
+        // 表项内能完整落在 B 位里的后续码字一并解出
+        for (uint32_t i = 0; i < (1u << B); i++) {
+            uint32_t entry = 0, count = 0, used = 0;
+            while (count < HUFF_TABLE_SYMS) {
+                uint32_t s = single[i >> used], l = s >> 8;
+                if (l == 0 || l > B - used) break;
+                entry |= (s & 0xFF) << (8 * count++);
+                used += l;
+            }
+            table[i] = entry | count << 24 | used << 26;
+        }
+        return true;
+    }
+
+    // 解码 n 个字节。位流不足或遇到无效码返回 false
+    bool decode(BitReader& r, unsigned char* out, size_t n) const {
+        const uint64_t mask = (1u << HUFF_MAX_CODE_BITS) - 1;
+        const unsigned char* in = r.in;
+        size_t pos = r.pos, size = r.size;
+        uint64_t acc = r.acc;  // 状态放在局部变量里，避免每次写 out 后重新读 r
+        int bits = r.n;
+        unsigned char* end = out + n;
+        // 快路径：一次补满 56 位以上，连查 4 次表（每次最多 12 位）
+        while (end - out >= 4 * HUFF_TABLE_SYMS && pos + 8 <= size) {
+            acc |= loadLE64(in + pos) << bits;
+            pos += (63 - bits) >> 3;
+            bits |= 56;
+            for (int k = 0; k < 4; k++) {
+                uint32_t e = table[acc & mask];
+                if (!(e >> 24 & 3)) return false;
+                out[0] = (unsigned char)e;
+                out[1] = (unsigned char)(e >> 8);
+                out[2] = (unsigned char)(e >> 16);
+                out += e >> 24 & 3;
+                acc >>= e >> 26;
+                bits -= int(e >> 26);
+            }
+        }
+        // 尾部：逐个符号，按需逐字节补充
+        while (out < end) {
+            for (; bits <= 56 && pos < size; bits += 8) acc |= uint64_t(in[pos++]) << bits;
+            uint32_t e = table[acc & mask];
+            int l = lengths[e & 0xFF];
+            if (!(e >> 24 & 3) || l > bits) return false;
+            *out++ = (unsigned char)e;
+            acc >>= l;
+            bits -= l;
+        }
+        r.pos = pos;
+        r.acc = acc;
+        r.n = bits;
+        return true;
+    }
+};
+
+// ---------- 内存与文件级压缩接口 ----------
+// 格式："HUF2" | 原始长度 u64 | 256 个码长，每个 4 位、两两打包成 128 字节 | 位流
+#define HUFF_HEADER_BYTES (4 + 8 + HUFF_SYMBOLS / 2)
+
+#define HUFF_BODY_HEADER_BYTES (HUFF_SYMBOLS / 2)
+
+// 编码体（码长表 + 位流）追加到 out 末尾；分块格式的每一块也是一个编码体
+static void huffEncodeBody(const unsigned char* data, size_t n, vector<unsigned char>& out) {
+    uint64_t freq[HUFF_SYMBOLS] = {0};
+    for (size_t i = 0; i < n; i++) freq[data[i]]++;
+    HuffTree tree(freq);
+
+    const unsigned char* lengths = tree.codeLengths();
+    for (int c = 0; c < HUFF_SYMBOLS; c += 2) out.push_back((unsigned char)(lengths[c] | lengths[c + 1] << 4));
+
+    size_t header = out.size();
+    out.resize(header + size_t((tree.encodedBits(freq) + 7) / 8) + 8);
+    BitWriter w(out.data() + header);
+    tree.encode(data, n, w);
+    out.resize(header + w.finish());
+}
+
+// 把 size 字节的编码体解码成 n 个字节
+static bool huffDecodeBody(const unsigned char* in, size_t size, unsigned char* out, size_t n) {
+    if (size < HUFF_BODY_HEADER_BYTES) return false;
+    unsigned char lengths[HUFF_SYMBOLS];
+    for (int c = 0; c < HUFF_SYMBOLS; c += 2) {
+        lengths[c] = in[c / 2] & 0x0F;
+        lengths[c + 1] = in[c / 2] >> 4;
+    }
+    HuffDecoder decoder;
+    if (!decoder.init(lengths)) return false;
+    BitReader r(in + HUFF_BODY_HEADER_BYTES, size - HUFF_BODY_HEADER_BYTES);
+    return decoder.decode(r, out, n);
+}
+
+void huffCompress(const unsigned char* data, size_t n, vector<unsigned char>& out) {
+    out.assign(HUFF_MAGIC, HUFF_MAGIC + 4);
+    unsigned char len[8];
+    storeLE64(len, uint64_t(n));
+    out.insert(out.end(), len, len + 8);
+    huffEncodeBody(data, n, out);
+}
+
+// 输入不完整或格式不符时返回 false
+bool huffDecompress(const unsigned char* in, size_t size, vector<unsigned char>& out) {
+    if (size < HUFF_HEADER_BYTES || memcmp(in, HUFF_MAGIC, 4) != 0) return false;
+    uint64_t n = loadLE64(in + 4);
+    if (n > uint64_t(size - HUFF_HEADER_BYTES) * 8) return false;  // 每个符号至少 1 位，先于分配输出拒绝
+    out.resize(size_t(n));
+    return huffDecodeBody(in + 12, size - 12, out.data(), out.size());
+}
+
+// ---------- 分块并行格式 ----------
+// "HUFB" | 原始长度 u64 | 块大小 u32 | 块数 u32 | 每块编码体的结束偏移 u64 × 块数 | 各块编码体。
+// 每块独立统计频率、独立建码表，块之间没有依赖：压缩时统计与编码在同一个任务里完成，
+// 解压时按偏移索引可以单独解出任意一块。码长表每块 128 字节，1 MB 的块只多出约 0.01%
+#define HUFF_BLOCK_MAGIC "HUFB"
+#define HUFF_BLOCK_SIZE (1 << 20)
+#define HUFF_BLOCK_HEADER_BYTES (4 + 8 + 4 + 4)
+
+void huffCompressBlocks(const unsigned char* data, size_t n, vector<unsigned char>& out, WorkStealingPool& pool,
+                        uint32_t blockSize = HUFF_BLOCK_SIZE) {
+    blockSize = max(blockSize, 1u);
+    size_t blocks = (n + blockSize - 1) / blockSize;
+    vector<vector<unsigned char>> parts(blocks);
+    {
+        TaskGroup group(pool);
+        for (size_t b = 0; b < blocks; b++) {
+            size_t begin = b * blockSize, len = min(size_t(blockSize), n - begin);
+            group.run([data, begin, len, &parts, b] { huffEncodeBody(data + begin, len, parts[b]); });
+        }
+        group.wait();
+    }
+
+    size_t index = HUFF_BLOCK_HEADER_BYTES, body = index + 8 * blocks, total = body;
+    vector<size_t> offsets(blocks);
+    for (size_t b = 0; b < blocks; b++) {
+        offsets[b] = total;
+        total += parts[b].size();
+    }
+    out.resize(total);
+    unsigned char* p = out.data();
+    memcpy(p, HUFF_BLOCK_MAGIC, 4);
+    storeLE64(p + 4, uint64_t(n));
+    for (int k = 0; k < 4; k++) {
+        p[12 + k] = (unsigned char)(blockSize >> (8 * k));
+        p[16 + k] = (unsigned char)(uint32_t(blocks) >> (8 * k));
+    }
+    for (size_t b = 0; b < blocks; b++) storeLE64(p + index + 8 * b, uint64_t(offsets[b] + parts[b].size() - body));
+    TaskGroup group(pool);
+    for (size_t b = 0; b < blocks; b++)
+        group.run([p, &offsets, &parts, b] { memcpy(p + offsets[b], parts[b].data(), parts[b].size()); });
+    group.wait();
+}
+
+// 分块格式的只读视图：open 校验头部与偏移索引，之后可按块随机解码
+class HuffBlockReader {
+private:
+    const unsigned char* body;
+    vector<uint64_t> ends;
+    uint64_t total;
+    uint32_t blockSize;
+
+public:
+    HuffBlockReader() : body(nullptr), total(0), blockSize(0) {}
+
+    // 头部、索引不合法或块的长度与位流对不上时返回 false
+    bool open(const unsigned char* in, size_t size) {
+        if (size < HUFF_BLOCK_HEADER_BYTES || memcmp(in, HUFF_BLOCK_MAGIC, 4) != 0) return false;
+        total = loadLE64(in + 4);
+        blockSize = 0;
+        uint32_t blocks = 0;
+        for (int k = 0; k < 4; k++) {
+            blockSize |= uint32_t(in[12 + k]) << (8 * k);
+            blocks |= uint32_t(in[16 + k]) << (8 * k);
+        }
+        if (blockSize == 0 || blocks > (size - HUFF_BLOCK_HEADER_BYTES) / 8 ||
+            blocks != total / blockSize + (total % blockSize != 0))
+            return false;
+        body = in + HUFF_BLOCK_HEADER_BYTES + 8 * size_t(blocks);
+        size_t bodyBytes = size - HUFF_BLOCK_HEADER_BYTES - 8 * size_t(blocks);
+        ends.resize(blocks);
+        uint64_t prev = 0;
+        for (uint32_t b = 0; b < blocks; b++) {
+            ends[b] = loadLE64(in + HUFF_BLOCK_HEADER_BYTES + 8 * size_t(b));
+            if (ends[b] < prev + HUFF_BODY_HEADER_BYTES || ends[b] > bodyBytes ||
+                blockLength(b) > (ends[b] - prev - HUFF_BODY_HEADER_BYTES) * 8)
+                return false;
+            prev = ends[b];
+        }
+        return prev == bodyBytes;
+    }
+
+    uint64_t length() const { return total; }
+    size_t blocks() const { return ends.size(); }
+    uint64_t blockBegin(size_t b) const { return uint64_t(b) * blockSize; }
+    size_t blockLength(size_t b) const { return size_t(min(uint64_t(blockSize), total - blockBegin(b))); }
+
+    // 解码第 b 块到 out，out 需有 blockLength(b) 字节
+    bool decodeBlock(size_t b, unsigned char* out) const {
+        uint64_t begin = b ? ends[b - 1] : 0;
+        return huffDecodeBody(body + begin, size_t(ends[b] - begin), out, blockLength(b));
+    }
+};
+
+bool huffDecompressBlocks(const unsigned char* in, size_t size, vector<unsigned char>& out, WorkStealingPool& pool) {
+    HuffBlockReader reader;
+    if (!reader.open(in, size)) return false;
+    out.resize(size_t(reader.length()));  // open 已保证长度不超过位流位数
+    atomic<bool> ok(true);
+    TaskGroup group(pool);
+    for (size_t b = 0; b < reader.blocks(); b++) {
+        unsigned char* dst = out.data() + reader.blockBegin(b);
+        group.run([&reader, &ok, dst, b] {
+            if (!reader.decodeBlock(b, dst)) ok = false;
+        });
+    }
+    group.wait();
+    return ok;
+}
+
+static bool readWholeFile(const char* path, vector<unsigned char>& data) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return false;
+    data.clear();
+    unsigned char chunk[1 << 16];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), fp)) > 0) data.insert(data.end(), chunk, chunk + got);
+    bool ok = !ferror(fp);
+    fclose(fp);
+    return ok;
+}
+
+static bool writeWholeFile(const char* path, const vector<unsigned char>& data) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(data.data(), 1, data.size(), fp) == data.size();
+    return (fclose(fp) == 0) && ok;
+}
+
+// ---------- 两遍流式编码 ----------
+// 第一遍只统计频率，第二遍按定长分段读入、编码进定长输出缓冲，写满就交给 sink。
+// 输出与 huffCompress 完全相同（HUF2），内存占用与输入大小无关。
+// sink 为可调用对象 bool(const unsigned char*, size_t)，返回 false 时中止；两遍之间输入不得改变
+#define HUFF_STREAM_CHUNK (1 << 16)
+
+template <class Sink>
+class HuffStreamWriter {
+private:
+    const HuffTree& tree;
+    Sink& sink;
+    unsigned char buf[HUFF_STREAM_CHUNK + 8];  // BitWriter 每次写 8 字节，末尾留余量
+    BitWriter w;
+    bool ok;
+
+public:
+    HuffStreamWriter(const HuffTree& t, Sink& s) : tree(t), sink(s), w(nullptr), ok(true) { w.out = buf; }
+
+    // 每次只编码缓冲余量一定装得下的一段，装不下时先把整字节交出去；未满一字节的尾部留在 w.acc 里
+    bool write(const unsigned char* data, size_t n) {
+        while (n > 0 && ok) {
+            size_t room = HUFF_STREAM_CHUNK - w.pos, take = min(n, room * 8 / HUFF_MAX_CODE_BITS);
+            if (take < 64 && take < n) {
+                ok = sink(buf, w.pos);
+                w.pos = 0;
+                continue;
+            }
+            tree.encode(data, take, w);
+            data += take;
+            n -= take;
+        }
+        return ok;
+    }
+
+    bool finish() {
+        storeLE64(buf + w.pos, w.acc);  // 交出后 pos 归零，尾部字节需重新落到缓冲里
+        size_t bytes = w.finish();
+        return ok && (bytes == 0 || sink(buf, bytes));
+    }
+};
+
+template <class Sink>
+static bool huffWriteStreamHeader(uint64_t n, const HuffTree& tree, Sink& sink) {
+    unsigned char header[HUFF_HEADER_BYTES];
+    memcpy(header, HUFF_MAGIC, 4);
+    storeLE64(header + 4, n);
+    const unsigned char* lengths = tree.codeLengths();
+    for (int c = 0; c < HUFF_SYMBOLS; c += 2) header[12 + c / 2] = (unsigned char)(lengths[c] | lengths[c + 1] << 4);
+    return sink(header, sizeof(header));
+}
+
+// in 需可回绕（文件流、字符串流），第二遍前 seekg 回到第一遍的起点
+template <class Sink>
+bool huffCompressStream(istream& in, Sink sink) {
+    streampos start = in.tellg();
+    if (start == streampos(-1)) return false;
+    vector<unsigned char> chunk(HUFF_STREAM_CHUNK);
+    uint64_t freq[HUFF_SYMBOLS] = {0}, n = 0;
+    while (in.read((char*)chunk.data(), chunk.size()) || in.gcount() > 0) {
+        size_t got = size_t(in.gcount());
+        for (size_t i = 0; i < got; i++) freq[chunk[i]]++;
+        n += got;
+    }
+    if (in.bad()) return false;
+    in.clear();
+    in.seekg(start);
+
+    HuffTree tree(freq);
+    if (!in || !huffWriteStreamHeader(n, tree, sink)) return false;
+    HuffStreamWriter<Sink> writer(tree, sink);
+    for (uint64_t left = n; left > 0;) {
+        in.read((char*)chunk.data(), streamsize(min(uint64_t(chunk.size()), left)));
+        size_t got = size_t(in.gcount());
+        if (got == 0 || !writer.write(chunk.data(), got)) return false;
+        left -= got;
+    }
+    return writer.finish();
+}
+
+// 内存映射输入：两遍都按窗口顺序扫映射区，扫完的窗口立即 MADV_DONTNEED 解除映射，
+// 否则驻留内存会随文件大小增长；不支持 mmap 的平台退回文件流
+#define HUFF_MAP_WINDOW (HUFF_STREAM_CHUNK * 16)
+
+template <class Sink>
+bool huffCompressMapped(const char* path, Sink sink) {
+#ifdef BITMAP_HAS_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t n = size_t(st.st_size);
+    const unsigned char* data = nullptr;
+    if (n > 0) {
+        void* base = mmap(NULL, n, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(base, n, MADV_SEQUENTIAL);
+        data = (const unsigned char*)base;
+    }
+    close(fd);
+
+    uint64_t freq[HUFF_SYMBOLS] = {0};
+    for (size_t begin = 0; begin < n; begin += HUFF_MAP_WINDOW) {
+        size_t end = min(n, begin + HUFF_MAP_WINDOW);
+        for (size_t i = begin; i < end; i++) freq[data[i]]++;
+        madvise((void*)(data + begin), end - begin, MADV_DONTNEED);
+    }
+    HuffTree tree(freq);
+    HuffStreamWriter<Sink> writer(tree, sink);
+    bool ok = huffWriteStreamHeader(uint64_t(n), tree, sink);
+    for (size_t begin = 0; ok && begin < n; begin += HUFF_MAP_WINDOW) {
+        size_t len = min(n - begin, size_t(HUFF_MAP_WINDOW));
+        ok = writer.write(data + begin, len);
+        madvise((void*)(data + begin), len, MADV_DONTNEED);
+    }
+    ok = ok && writer.finish();
+    if (n > 0) munmap((void*)data, n);
+    return ok;
+#else
+    ifstream in(path, ios::binary);
+    return in && huffCompressStream(in, sink);
+#endif
+}
+
+// 流式压缩到文件：输出为单块 HUF2 格式，可用 huffDecompress 解开
+bool huffCompressFileStreaming(const char* inPath, const char* outPath) {
+    FILE* fp = fopen(outPath, "wb");
+    if (!fp) return false;
+    bool ok = huffCompressMapped(inPath, [fp](const unsigned char* p, size_t len) { return fwrite(p, 1, len, fp) == len; });
+    return (fclose(fp) == 0) && ok;
+}
+
+// 文件接口写分块格式，用满全部硬件线程；解压按魔数同时接受单块格式
+bool huffCompressFile(const char* inPath, const char* outPath) {
+    vector<unsigned char> data, packed;
+    if (!readWholeFile(inPath, data)) return false;
+    WorkStealingPool pool;
+    huffCompressBlocks(data.data(), data.size(), packed, pool);
+    return writeWholeFile(outPath, packed);
+}
+
+bool huffDecompressFile(const char* inPath, const char* outPath) {
+    vector<unsigned char> packed, data;
+    if (!readWholeFile(inPath, packed)) return false;
+    WorkStealingPool pool;
+    bool ok = packed.size() >= 4 && memcmp(packed.data(), HUFF_BLOCK_MAGIC, 4) == 0
+                  ? huffDecompressBlocks(packed.data(), packed.size(), data, pool)
+                  : huffDecompress(packed.data(), packed.size(), data);
+    return ok && writeWholeFile(outPath, data);
+}
+
+// ====================== 位图校验与性能测试 ======================
+// 按密度 density 随机置位
+Bitmap randomBitmap(Rank bits, double density, unsigned seed) {
+    Bitmap bmp(bits);
+    mt19937 gen(seed);
+    bernoulli_distribution coin(density);
+    for (Rank k = 0; k < bits; k++)
+        if (coin(gen)) bmp.set(k);
+    return bmp;
+}
+
+// 与 vector<bool> 逐位对照：计数、位运算、迭代、rank/select、文件往返
+bool checkBitmap(Rank bits) {
+    Bitmap a = randomBitmap(bits, 0.3, 1), b = randomBitmap(bits / 2, 0.01, 2);
+    vector<bool> ra(bits), rb(bits);
+    for (Rank k = 0; k < bits; k++) ra[k] = a.test(k), rb[k] = b.test(k);
+
+    bool ok = a.count() == a.size() && b.count() == b.size();
+    Bitmap ops[4] = {a & b, a | b, a ^ b, Bitmap(a).andNot(b)};
+    for (Rank k = 0; k < bits; k++) {
+        bool expect[4] = {ra[k] && rb[k], ra[k] || rb[k], ra[k] != rb[k], ra[k] && !rb[k]};
+        for (int i = 0; i < 4; i++) ok = ok && ops[i].test(k) == expect[i];
+    }
+    for (int i = 0; i < 4; i++) ok = ok && ops[i].size() == ops[i].count();
+
+    vector<Rank> visited;
+    a.forEach([&](Rank k) { visited.push_back(k); });
+    Rank seen = 0, prefix = 0;
+    for (Rank k = a.findFirst(); k >= 0; k = a.findNext(k + 1)) {
+        ok = ok && ra[k] && a.select(seen) == k && visited[seen] == k;
+        seen++;
+    }
+    ok = ok && seen == a.size() && a.select(seen) == -1;
+    for (Rank k = 0; k <= bits; k++) {
+        if (a.rank(k) != prefix) ok = false;
+        if (k < bits) prefix += ra[k];
+    }
+
+    const char* tmp = "bitmap_check.bin";
+    a.dump(tmp);
+    Bitmap back(tmp, bits);
+    remove(tmp);
+    ok = ok && back.size() == a.size();
+    for (Rank k = 0; k < bits; k++) ok = ok && back.test(k) == ra[k];
+    return ok;
+}
+
+// 映射文件：三种映射方式的写入语义、扩容、未 sync 就退出后的重新计数
+bool checkBitmapFile(Rank bits) {
+    const char* path = "bitmap_map_check.bin";
+    Bitmap a = randomBitmap(bits, 0.3, 11), heap, ro, cow;
+    bool ok = a.save(path) && heap.load(path) && ro.mapFile(path, BITMAP_MAP_READONLY) &&
+              cow.mapFile(path, BITMAP_MAP_PRIVATE) && ro.storageMode() == BITMAP_MAP_READONLY;
+    ok = ok && heap.size() == a.size() && ro.size() == a.size() && cow.size() == a.size();
+    for (Rank k = 0; k < bits; k++) ok = ok && heap.test(k) == a.test(k) && ro.test(k) == a.test(k);
+    ro.set(1), ro.clear(2), cow.set(3), cow.clear(4);  // 只读映射先复制到堆上；写时复制只改私有页
+    ok = ok && ro.storageMode() == BITMAP_HEAP && cow.storageMode() == BITMAP_MAP_PRIVATE;
+    ok = ok && ro.test(1) && !ro.test(2) && cow.test(3) && !cow.test(4) && cow.size() == cow.count();
+    {
+        Bitmap shared;
+        ok = ok && shared.mapFile(path, BITMAP_MAP_SHARED);
+        shared.set(5), shared.clear(6), shared.set(2 * bits);  // 越界写入使文件变长
+        ok = ok && shared.storageMode() == BITMAP_MAP_SHARED && shared.sync();
+    }
+    Bitmap back;
+    ok = ok && back.mapFile(path, BITMAP_MAP_READONLY) && back.test(5) && !back.test(6) && back.test(2 * bits);
+    ok = ok && back.test(1) == a.test(1) && back.test(3) == a.test(3) && back.test(4) == a.test(4);
+    ok = ok && back.size() == back.count();
+#ifdef BITMAP_HAS_MMAP
+    pid_t child = fork();  // 子进程改完直接退出，不 sync，文件头留下 DIRTY
+    if (child == 0) {
+        Bitmap crash;
+        if (crash.mapFile(path, BITMAP_MAP_SHARED)) crash.set(7), crash.set(8), crash.clear(9);
+        _exit(0);
+    }
+    if (child > 0) {
+        while (waitpid(child, NULL, 0) < 0 && errno == EINTR) {}
+        Bitmap recovered;
+        ok = ok && recovered.mapFile(path, BITMAP_MAP_READONLY) && recovered.test(7) && recovered.test(8);
+        ok = ok && !recovered.test(9) && recovered.size() == recovered.count();
+    }
+#endif
+    ok = ok && !back.mapFile("bitmap_missing.bin", BITMAP_MAP_READONLY) && back.test(5);  // 失败时保持原内容
+    remove(path);
+    return ok;
+}
+
+void testBitmap(BenchReport& report, const BenchConfig& cfg, Rank bits) {
+    cout << "\n=== 位图 (" << bits << " 位, " << (bits / 8 >> 20) << " MB) ===\n";
+    cout << "  逐位对照校验: " << (checkBitmap(1 << 16) ? "通过" : "失败!") << "\n";
+    cout << "  映射文件校验: " << (checkBitmapFile(1 << 16) ? "通过" : "失败!") << "\n";
+
+    Bitmap a = randomBitmap(bits, 0.5, 3), b = randomBitmap(bits, 0.1, 4), work;
+    vector<Rank> queries(1 << 20), ranks(queries.size());
+    mt19937_64 gen(5);
+    for (size_t i = 0; i < queries.size(); i++) queries[i] = Rank(gen() % uint64_t(bits));
+    a.buildRankIndex();
+    for (size_t i = 0; i < queries.size(); i++) ranks[i] = Rank(gen() % uint64_t(a.size()));
+
+    size_t first = report.results().size();
+    long long sink = 0;
+    report.add(runBenchmark("count-bitwise", "random", bits, cfg, [] {}, [&] {
+        Rank cnt = 0;
+        for (Rank k = 0; k < bits; k++) cnt += a.test(k);
+        sink += cnt;
+    }));
+    report.add(runBenchmark("count-popcnt", "random", bits, cfg, [] {}, [&] { sink += a.count(); }));
+    report.add(runBenchmark("and", "random", bits, cfg, [&] { work = a; }, [&] { work &= b; }));
+    report.add(runBenchmark("or", "random", bits, cfg, [&] { work = a; }, [&] { work |= b; }));
+    report.add(runBenchmark("xor", "random", bits, cfg, [&] { work = a; }, [&] { work ^= b; }));
+    report.add(runBenchmark("andnot", "random", bits, cfg, [&] { work = a; }, [&] { work.andNot(b); }));
+    report.add(runBenchmark("iterate", "random", b.size(), cfg, [] {}, [&] {
+        long long sum = 0;
+        for (Rank k = b.findFirst(); k >= 0; k = b.findNext(k + 1)) sum += k;
+        sink += sum;
+    }));
+    report.add(runBenchmark("foreach", "random", b.size(), cfg, [] {}, [&] {
+        long long sum = 0;
+        b.forEach([&](Rank k) { sum += k; });
+        sink += sum;
+    }));
+    report.add(runBenchmark("rank-index", "random", bits, cfg, [&] { work = a; },
+                            [&] { work.buildRankIndex(); }));
+    report.add(runBenchmark("rank", "random", queries.size(), cfg, [] {}, [&] {
+        long long sum = 0;
+        for (Rank q : queries) sum += a.rank(q);
+        sink += sum;
+    }));
+    report.add(runBenchmark("select", "random", ranks.size(), cfg, [] {}, [&] {
+        long long sum = 0;
+        for (Rank q : ranks) sum += a.select(q);
+        sink += sum;
+    }));
+
+    // 启动时打开位图只探测少量位：fread + 逐位计数、整体读入、只读映射三种方式
+    const char* legacyPath = "bitmap_bench_legacy.bin";
+    const char* mappedPath = "bitmap_bench_mapped.bin";
+    if (a.dump(legacyPath) && a.save(mappedPath)) {
+        auto probe = [&](Bitmap& bmp) {
+            long long hits = 0;
+            for (size_t i = 0; i < 1000; i++) hits += bmp.test(queries[i]);
+            sink += hits + bmp.size();
+        };
+        report.add(runBenchmark("open-fread", "random", bits, cfg, [] {}, [&] {
+            Bitmap bmp(legacyPath, bits);
+            probe(bmp);
+        }));
+        report.add(runBenchmark("open-load", "random", bits, cfg, [] {}, [&] {
+            Bitmap bmp;
+            if (bmp.load(mappedPath)) probe(bmp);
+        }));
+        report.add(runBenchmark("open-mmap", "random", bits, cfg, [] {}, [&] {
+            Bitmap bmp;
+            if (bmp.mapFile(mappedPath, BITMAP_MAP_READONLY)) probe(bmp);
+        }));
+    }
+    remove(legacyPath);
+    remove(mappedPath);
+    report.printTable(cout, first);
+    doNotOptimize(sink);
+}
+
+// ====================== 压缩位图校验与性能测试 ======================
+// 稀疏随机值 + 稠密簇 + 长区间，覆盖三种容器
+RoaringBitmap randomRoaring(vector<uint32_t>& ref, unsigned seed) {
+    RoaringBitmap r;
+    mt19937 gen(seed);
+    for (int i = 0; i < 20000; i++) ref.push_back(uint32_t(gen()));
+    uint32_t base = (gen() % 64) << 16;
+    for (int i = 0; i < 30000; i++) ref.push_back(base + (gen() & 0xFFFF));
+    for (int i = 0; i < 8; i++) {
+        uint32_t lo = (gen() % 64) << 16 | (gen() & 0xFFFF), len = gen() % 200000;
+        r.addRange(lo, uint64_t(lo) + len);
+        for (uint32_t k = 0; k < len; k++) ref.push_back(lo + k);
+    }
+    for (uint32_t v : ref) r.add(v);
+    sort(ref.begin(), ref.end());
+    ref.erase(unique(ref.begin(), ref.end()), ref.end());
+    return r;
+}
+
+bool sameContents(const RoaringBitmap& r, const vector<uint32_t>& ref) {
+    if (r.cardinality() != ref.size()) return false;
+    size_t i = 0;
+    bool ok = true;
+    r.forEach([&](uint32_t v) { ok = ok && i < ref.size() && ref[i++] == v; });
+    return ok;
+}
+
+bool checkRoaring() {
+    vector<uint32_t> ra, rb, expect;
+    RoaringBitmap a = randomRoaring(ra, 7), b = randomRoaring(rb, 8);
+    bool ok = sameContents(a, ra) && sameContents(b, rb);
+    for (int pass = 0; pass < 2; pass++) {  // 第二轮先 runOptimize，覆盖游程容器参与的运算
+        expect.clear();
+        set_intersection(ra.begin(), ra.end(), rb.begin(), rb.end(), back_inserter(expect));
+        ok = ok && sameContents(a & b, expect);
+        expect.clear();
+        set_union(ra.begin(), ra.end(), rb.begin(), rb.end(), back_inserter(expect));
+        ok = ok && sameContents(a | b, expect);
+        expect.clear();
+        set_symmetric_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), back_inserter(expect));
+        ok = ok && sameContents(a ^ b, expect);
+        expect.clear();
+        set_difference(ra.begin(), ra.end(), rb.begin(), rb.end(), back_inserter(expect));
+        ok = ok && sameContents(andNot(a, b), expect);
+
+        vector<unsigned char> bytes;
+        a.serialize(bytes);
+        RoaringBitmap back;
+        ok = ok && back.deserialize(bytes.data(), bytes.size()) && sameContents(back, ra);
+        ok = ok && !back.deserialize(bytes.data(), bytes.size() - 1) && sameContents(back, ra);
+        a.runOptimize();
+        b.runOptimize();
+        ok = ok && sameContents(a, ra);
+    }
+    for (size_t i = 0; i < ra.size(); i += 3) a.remove(ra[i]);
+    for (size_t i = 0; i < ra.size(); i++) ok = ok && a.contains(ra[i]) == (i % 3 != 0);
+
+    // 可移植格式样例：{1, 2, 3}，无游程容器
+    const unsigned char golden[] = {0x3A, 0x30, 0, 0, 1, 0, 0, 0, 0, 0, 2, 0, 16, 0, 0, 0, 1, 0, 2, 0, 3, 0};
+    RoaringBitmap small;
+    small.add(3), small.add(1), small.add(2);
+    vector<unsigned char> bytes;
+    small.serialize(bytes);
+    ok = ok && bytes == vector<unsigned char>(golden, golden + sizeof(golden));
+    return ok;
+}
+
+void testRoaring(BenchReport& report, const BenchConfig& cfg) {
+    cout << "\n=== 压缩位图 (Roaring) ===\n";
+    cout << "  与有序数组对照校验: " << (checkRoaring() ? "通过" : "失败!") << "\n";
+
+    // 稀疏：1M 个值均匀散布在 32 位空间；游程：每 2^20 一段长 50000 的区间
+    mt19937 gen(9);
+    RoaringBitmap sparse, runs, sparse2;
+    for (int i = 0; i < 1000000; i++) sparse.add(uint32_t(gen())), sparse2.add(uint32_t(gen()));
+    sparse.runOptimize();
+    for (uint64_t lo = 0; lo < (uint64_t(1) << 32); lo += 1 << 20) runs.addRange(lo, lo + 50000);
+    runs.runOptimize();
+    double denseMB = double(uint64_t(1) << 32) / 8 / (1 << 20);
+    printf("  %-8s 元素 %10llu, 容器 %6zu, 内存 %8.2f MB, 序列化 %8.2f MB（稠密位图需 %.0f MB）\n", "稀疏",
+           (unsigned long long)sparse.cardinality(), sparse.containerCount(), sparse.sizeInBytes() / 1048576.0,
+           [&] { vector<unsigned char> b; sparse.serialize(b); return b.size() / 1048576.0; }(), denseMB);
+    printf("  %-8s 元素 %10llu, 容器 %6zu, 内存 %8.2f MB, 序列化 %8.2f MB（稠密位图需 %.0f MB）\n", "游程",
+           (unsigned long long)runs.cardinality(), runs.containerCount(), runs.sizeInBytes() / 1048576.0,
+           [&] { vector<unsigned char> b; runs.serialize(b); return b.size() / 1048576.0; }(), denseMB);
+
+    size_t first = report.results().size();
+    uint64_t sink = 0;
+    report.add(runBenchmark("roaring-and", "sparse", sparse.cardinality(), cfg, [] {},
+                            [&] { sink += (sparse & sparse2).cardinality(); }));
+    report.add(runBenchmark("roaring-or", "sparse", sparse.cardinality(), cfg, [] {},
+                            [&] { sink += (sparse | sparse2).cardinality(); }));
+    report.add(runBenchmark("roaring-and", "runs", runs.cardinality(), cfg, [] {},
+                            [&] { sink += (runs & sparse).cardinality(); }));
+    report.add(runBenchmark("roaring-or", "runs", runs.cardinality(), cfg, [] {},
+                            [&] { sink += (runs | sparse).cardinality(); }));
+    report.add(runBenchmark("roaring-probe", "sparse", 1 << 20, cfg, [] {}, [&] {
+        uint64_t hits = 0;
+        for (uint32_t k = 0; k < (1u << 20); k++) hits += sparse.contains(k * 4099u);
+        sink += hits;
+    }));
+    vector<unsigned char> bytes;
+    report.add(runBenchmark("roaring-save", "sparse", sparse.cardinality(), cfg, [&] { bytes.clear(); },
+                            [&] { sparse.serialize(bytes); }));
+    RoaringBitmap back;
+    report.add(runBenchmark("roaring-load", "sparse", sparse.cardinality(), cfg, [] {},
+                            [&] { sink += back.deserialize(bytes.data(), bytes.size()); }));
+    report.printTable(cout, first);
+    doNotOptimize(sink);
+}
+
+// ====================== Huffman 校验与吞吐测试 ======================
+// 合成英文语料：词表取自演讲稿，按 Zipf 分布抽词，夹杂标点与换行
+string makeTextCorpus(size_t bytes, unsigned seed) {
+    const char* vocab[] = {"the", "of", "and", "a", "to", "in", "is", "that", "it", "was", "for", "on", "are", "with",
+                           "as", "I", "his", "they", "be", "at", "one", "have", "this", "from", "dream", "nation",
+                           "freedom", "will", "day", "sons", "former", "slaves", "table", "brotherhood", "Georgia",
+                           "hills", "truths", "evident", "created", "equal", "together", "meaning", "creed", "live"};
+    const int words = sizeof(vocab) / sizeof(vocab[0]);
+    vector<double> weight(words);
+    for (int i = 0; i < words; i++) weight[i] = 1.0 / (i + 1);
+    discrete_distribution<int> pick(weight.begin(), weight.end());
+    mt19937 gen(seed);
+    string text;
+    text.reserve(bytes + 16);
+    while (text.size() < bytes) {
+        text += vocab[pick(gen)];
+        unsigned r = gen() % 100;
+        text += r < 80 ? " " : r < 92 ? ", " : r < 98 ? ". " : ".\n";
+    }
+    text.resize(bytes);
+    return text;
+}
+
+static bool roundTrip(const unsigned char* data, size_t n) {
+    vector<unsigned char> packed, back;
+    huffCompress(data, n, packed);
+    return huffDecompress(packed.data(), packed.size(), back) && back.size() == n &&
+           (n == 0 || memcmp(back.data(), data, n) == 0);
+}
+
+// 往返一致：空输入、单一字节、全部 256 个字节、偏斜分布；截断与篡改的输入必须被拒绝
+bool checkHuffman() {
+    mt19937 gen(21);
+    vector<unsigned char> data(100000);
+    bool ok = roundTrip(data.data(), 0) && roundTrip(data.data(), data.size());  // 全 0
+    for (auto& b : data) b = (unsigned char)gen();
+    ok = ok && roundTrip(data.data(), data.size());
+    geometric_distribution<int> skew(0.3);
+    for (auto& b : data) b = (unsigned char)min(skew(gen), 255);
+    ok = ok && roundTrip(data.data(), data.size());
+
+    // 频率取斐波那契数，未限长时最长码可达 29 位，用来触发包合并
+    vector<unsigned char> fib;
+    for (uint64_t a = 1, b = 1, c = 0; c < 30; c++, a += b, swap(a, b)) fib.insert(fib.end(), size_t(a), (unsigned char)c);
+    shuffle(fib.begin(), fib.end(), gen);
+    HuffTree limited(string(fib.begin(), fib.end()));
+    for (int c = 0; c < HUFF_SYMBOLS; c++) ok = ok && limited.code((unsigned char)c).len <= HUFF_MAX_CODE_BITS;
+    ok = ok && roundTrip(fib.data(), fib.size());
+
+    vector<unsigned char> packed, back;
+    huffCompress(data.data(), data.size(), packed);
+    ok = ok && !huffDecompress(packed.data(), packed.size() - 1, back) && !huffDecompress(packed.data(), 10, back);
+    packed[12] = 0x11;
+    packed[13] = 0x11;  // 码长超额（Kraft 和大于 1）
+    ok = ok && !huffDecompress(packed.data(), packed.size(), back);
+    packed[0] ^= 1;
+    ok = ok && !huffDecompress(packed.data(), packed.size(), back);
+
+    // 流式编码与一次性编码逐字节一致：字符串流、内存映射文件、sink 中途失败
+    string streamText = makeTextCorpus(300000, 3);
+    vector<unsigned char> streamed;
+    auto collect = [&streamed](const unsigned char* p, size_t len) {
+        streamed.insert(streamed.end(), p, p + len);
+        return true;
+    };
+    for (size_t n : {size_t(0), size_t(1), size_t(HUFF_STREAM_CHUNK), streamText.size()}) {
+        huffCompress((const unsigned char*)streamText.data(), n, packed);
+        istringstream in(streamText.substr(0, n));
+        streamed.clear();
+        ok = ok && huffCompressStream(in, collect) && streamed == packed;
+    }
+    const char* streamPath = "huff_stream.txt";
+    {
+        ofstream fout(streamPath, ios::binary);
+        fout << streamText;
+    }
+    streamed.clear();
+    ok = ok && huffCompressMapped(streamPath, collect) && streamed == packed;
+    size_t calls = 0;
+    ok = ok && !huffCompressMapped(streamPath, [&calls](const unsigned char*, size_t) { return ++calls < 3; });
+    remove(streamPath);
+
+    // 分块格式：整体往返、按块随机解码、索引损坏
+    WorkStealingPool pool(2);
+    string blockText = makeTextCorpus(300000, 2);
+    vector<unsigned char> raw(blockText.begin(), blockText.end());
+    for (size_t n : {size_t(0), size_t(1), size_t(65536), raw.size()}) {
+        huffCompressBlocks(raw.data(), n, packed, pool, 65536);
+        ok = ok && huffDecompressBlocks(packed.data(), packed.size(), back, pool) &&
+             back == vector<unsigned char>(raw.begin(), raw.begin() + n);
+    }
+    HuffBlockReader reader;
+    ok = ok && reader.open(packed.data(), packed.size()) && reader.blocks() == 5;
+    vector<unsigned char> block(reader.blockLength(3));
+    ok = ok && reader.decodeBlock(3, block.data()) && memcmp(block.data(), raw.data() + 3 * 65536, block.size()) == 0;
+    ok = ok && !huffDecompressBlocks(packed.data(), packed.size() - 1, back, pool);
+    packed[HUFF_BLOCK_HEADER_BYTES + 8] ^= 1;  // 第 1 块的结束偏移
+    ok = ok && !huffDecompressBlocks(packed.data(), packed.size(), back, pool);
+
+    const char *src = "huff_check.txt", *dst = "huff_check.huf", *out = "huff_check.out";
+    string text = makeTextCorpus(50000, 1);
+    vector<unsigned char> again;
+    raw.assign(text.begin(), text.end());
+    ok = ok && writeWholeFile(src, raw) && huffCompressFile(src, dst) && huffDecompressFile(dst, out) &&
+         readWholeFile(out, again) && again == raw;
+    remove(src), remove(dst), remove(out);
+    return ok;
+}
+
+// corpusPath 非空时使用该文件作为语料，否则生成 corpusBytes 字节的合成文本
+void testHuffman(BenchReport& report, const BenchConfig& cfg, size_t corpusBytes, const char* corpusPath) {
+    cout << "\n=== Huffman 编解码 ===\n";
+    cout << "  往返与异常输入校验: " << (checkHuffman() ? "通过" : "失败!") << "\n";
+
+    vector<unsigned char> corpus;
+    string dataset = "synthetic-text";
+    if (corpusPath && readWholeFile(corpusPath, corpus)) {
+        dataset = corpusPath;
+    } else {
+        string text = makeTextCorpus(corpusBytes, 7);
+        corpus.assign(text.begin(), text.end());
+    }
+    vector<unsigned char> packed, back;
+    BenchResult enc = runBenchmark("huff-encode", "bytes", corpus.size(), cfg, [] {},
+                                   [&] { huffCompress(corpus.data(), corpus.size(), packed); });
+    BenchResult dec = runBenchmark("huff-decode", "bytes", corpus.size(), cfg, [] {},
+                                   [&] { huffDecompress(packed.data(), packed.size(), back); });
+    enc.dataset = dec.dataset = dataset;
+    report.add(enc);
+    report.add(dec);
+    bool same = back == corpus;
+    double mb = corpus.size() / 1048576.0;
+    printf("  语料 %s: %.1f MB, 压缩后 %.1f MB (%.1f%%)%s\n", dataset.c_str(), mb, packed.size() / 1048576.0,
+           corpus.empty() ? 0.0 : 100.0 * packed.size() / corpus.size(), same ? "" : ", 解码结果不一致!");
+    report.printTable(cout, report.results().size() - 2);
+    if (enc.unit == "ms") printf("  编码 %.1f MB/s, 解码 %.1f MB/s\n", mb / (enc.median / 1000), mb / (dec.median / 1000));
+
+    // 流式编码：语料写入临时文件，内存映射两遍扫描，输出只计字节数不落盘
+    const char* streamPath = "huff_stream_bench.txt";
+    if (writeWholeFile(streamPath, corpus)) {
+        uint64_t streamedBytes = 0;
+        BenchResult stream = runBenchmark("huff-stream-mmap", "bytes", corpus.size(), cfg, [] {}, [&] {
+            streamedBytes = 0;
+            huffCompressMapped(streamPath, [&streamedBytes](const unsigned char*, size_t len) {
+                streamedBytes += len;
+                return true;
+            });
+        });
+        stream.dataset = dataset;
+        report.add(stream);
+        remove(streamPath);
+        if (stream.unit == "ms")
+            printf("  流式编码（%d KB 输出缓冲）%.1f MB/s, 输出 %.1f MB%s\n", HUFF_STREAM_CHUNK >> 10,
+                   mb / (stream.median / 1000), streamedBytes / 1048576.0, streamedBytes == packed.size() ? "" : "，与一次性编码长度不一致!");
+    }
+
+    // 每条短消息单独建树：1 KB 一条，只统计频率并建码表
+    const size_t message = 1024, messages = min(size_t(4096), corpus.size() / message);
+    vector<uint64_t> hist(messages * HUFF_SYMBOLS, 0);
+    for (size_t m = 0; m < messages; m++)
+        for (size_t i = 0; i < message; i++) hist[m * HUFF_SYMBOLS + corpus[m * message + i]]++;
+    long long sink = 0;
+    BenchResult trees = runBenchmark("huff-tree-build", "messages", messages, cfg, [] {}, [&] {
+        long long sum = 0;
+        for (size_t m = 0; m < messages; m++) sum += HuffTree(&hist[m * HUFF_SYMBOLS]).code('e').len;
+        sink += sum;
+    });
+    trees.dataset = dataset;
+    report.add(trees);
+    if (trees.unit == "ms" && messages)
+        printf("  每条消息建树 %.2f us（%zu 条）\n", trees.median * 1000 / messages, messages);
+    doNotOptimize(sink);
+
+    // 分块格式按线程数扩展
+    size_t first = report.results().size();
+    for (unsigned t : scalingThreadCounts()) {
+        WorkStealingPool pool(t);
+        BenchResult benc = runBenchmark("huffb-enc-t" + to_string(t), "bytes", corpus.size(), cfg, [] {},
+                                        [&] { huffCompressBlocks(corpus.data(), corpus.size(), packed, pool); });
+        BenchResult bdec = runBenchmark("huffb-dec-t" + to_string(t), "bytes", corpus.size(), cfg, [] {},
+                                        [&] { huffDecompressBlocks(packed.data(), packed.size(), back, pool); });
+        benc.dataset = bdec.dataset = dataset;
+        report.add(benc);
+        report.add(bdec);
+        if (back != corpus) printf("  %u 线程分块解码结果不一致!\n", t);
+    }
+    printf("  分块格式（%d KB/块）压缩后 %.1f MB\n", HUFF_BLOCK_SIZE >> 10, packed.size() / 1048576.0);
+    report.printTable(cout, first);
+}
+
+int main(int argc, char** argv) {
+    // 命令行：--csv=路径 / --json=路径 导出结果，--cycles 用周期计数器计时，--samples=N 设置采样次数；--bitmap-bits=N 设置位图测试规模；
+    // --huff-mb=N 设置合成语料大小，--huff-corpus=文件 改用真实语料；
+    // --compress 输入 输出 / --decompress 输入 输出 只做文件压缩或解压；--compress-stream 输入 输出 以恒定内存流式压缩
+    BenchOutput benchOutput = parseBenchArgs(argc, argv);
+    BenchConfig benchConfig = benchConfigFor(benchOutput);
+    BenchReport benchReport;
+    Rank bitmapBits = 1 << 26;
+    size_t huffBytes = size_t(32) << 20;
+    const char* huffCorpus = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--bitmap-bits=", 14) == 0) bitmapBits = max(1LL, atoll(argv[i] + 14));
+        else if (strncmp(argv[i], "--huff-mb=", 10) == 0) huffBytes = size_t(max(1, atoi(argv[i] + 10))) << 20;
+        else if (strncmp(argv[i], "--huff-corpus=", 14) == 0) huffCorpus = argv[i] + 14;
+        else if ((strcmp(argv[i], "--compress") == 0 || strcmp(argv[i], "--decompress") == 0 ||
+                  strcmp(argv[i], "--compress-stream") == 0) && i + 2 < argc) {
+            bool ok = argv[i][2] == 'd'                        ? huffDecompressFile(argv[i + 1], argv[i + 2])
+                      : strcmp(argv[i], "--compress-stream") == 0 ? huffCompressFileStreaming(argv[i + 1], argv[i + 2])
+                                                                  : huffCompressFile(argv[i + 1], argv[i + 2]);
+            if (!ok) fprintf(stderr, "%s %s -> %s 失败\n", argv[i], argv[i + 1], argv[i + 2]);
+            return ok ? 0 : 1;
+        }
+    }
+
     string speech =
         "I have a dream that one day this nation will rise up and live out the true meaning of its creed "
         "we hold these truths to be self evident that all men are created equal I have a dream that one day "
@@ -196,5 +2418,9 @@ int main() {
         delete[] bitStr;
     }
 
+    testBitmap(benchReport, benchConfig, bitmapBits);
+    testRoaring(benchReport, benchConfig);
+    testHuffman(benchReport, benchConfig, huffBytes, huffCorpus);
+    writeBenchOutput(benchReport, benchOutput);
     return 0;
 }
@@ -5,6 +5,10 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <thread>
+
+#include "../common/benchmark.h"
+#include "../common/parallel_merge_sort.h"
 
 using namespace std;
 using namespace chrono;
@@ -20,12 +24,6 @@ struct BBox {
     BBox() : x1(0), y1(0), x2(0), y2(0), score(0) {}
 };
 
-// 计时工具宏：简化耗时统计
-#define TIME_START auto start = high_resolution_clock::now();
-#define TIME_END auto end = high_resolution_clock::now(); \
-    duration<double, milli> elapsed = end - start; \
-    return elapsed.count();
-
 // ====================== 排序算法实现 ======================
 // 快速排序 - 分区函数
 int partition(vector<BBox>& bboxes, int low, int high) {
@@ -50,16 +48,8 @@ void quickSort(vector<BBox>& bboxes, int low, int high) {
     }
 }
 
-// 快速排序 - 带计时封装
-double quickSortWithTime(vector<BBox> bboxes) {
-    TIME_START
-    quickSort(bboxes, 0, bboxes.size() - 1);
-    TIME_END
-}
-
-// 冒泡排序 - 带计时封装
-double bubbleSortWithTime(vector<BBox> bboxes) {
-    TIME_START
+// 冒泡排序（降序）
+void bubbleSort(vector<BBox>& bboxes) {
     int n = bboxes.size();
     for (int i = 0; i < n - 1; i++) {
         for (int j = 0; j < n - i - 1; j++) {
@@ -68,12 +58,10 @@ double bubbleSortWithTime(vector<BBox> bboxes) {
             }
         }
     }
-    TIME_END
 }
 
-// 插入排序 - 带计时封装
-double insertionSortWithTime(vector<BBox> bboxes) {
-    TIME_START
+// 插入排序（降序）
+void insertionSort(vector<BBox>& bboxes) {
     int n = bboxes.size();
     for (int i = 1; i < n; i++) {
         BBox key = bboxes[i];
@@ -85,7 +73,6 @@ double insertionSortWithTime(vector<BBox> bboxes) {
         }
         bboxes[j + 1] = key;
     }
-    TIME_END
 }
 
 // 归并排序 - 归并操作
@@ -125,11 +112,71 @@ void mergeSort(vector<BBox>& bboxes, int left, int right) {
     }
 }
 
-// 归并排序 - 带计时封装
-double mergeSortWithTime(vector<BBox> bboxes) {
-    TIME_START
-    mergeSort(bboxes, 0, bboxes.size() - 1);
-    TIME_END
+// 自底向上归并排序 - 小段插入排序的长度
+const int MERGE_RUN = 32;
+
+// 自底向上归并排序 - 将 src 中相邻两段 [left, mid)、[mid, right) 归并到 dst（降序，稳定）
+void mergeRuns(const BBox* src, BBox* dst, int left, int mid, int right) {
+    int i = left, j = mid, k = left;
+    while (i < mid && j < right) {
+        if (src[i].score >= src[j].score) {
+            dst[k++] = src[i++];
+        } else {
+            dst[k++] = src[j++];
+        }
+    }
+    while (i < mid) { dst[k++] = src[i++]; }
+    while (j < right) { dst[k++] = src[j++]; }
+}
+
+// 自底向上归并排序 - 非递归核心：原数组与 scratch 来回归并，只使用这一块缓冲区
+void bottomUpSortRange(BBox* bboxes, BBox* scratch, int n) {
+    if (n < 2) return;
+
+    // 第一步：每 MERGE_RUN 个元素做一次插入排序
+    for (int lo = 0; lo < n; lo += MERGE_RUN) {
+        int hi = min(lo + MERGE_RUN, n);
+        for (int i = lo + 1; i < hi; i++) {
+            BBox key = bboxes[i];
+            int j = i - 1;
+            while (j >= lo && bboxes[j].score < key.score) {
+                bboxes[j + 1] = bboxes[j];
+                j--;
+            }
+            bboxes[j + 1] = key;
+        }
+    }
+
+    // 第二步：段长逐轮翻倍，src/dst 交替
+    BBox* src = bboxes;
+    BBox* dst = scratch;
+    for (int width = MERGE_RUN; width < n; width *= 2) {
+        for (int left = 0; left < n; left += 2 * width) {
+            int mid = min(left + width, n);
+            int right = min(left + 2 * width, n);
+            mergeRuns(src, dst, left, mid, right);
+        }
+        swap(src, dst);
+    }
+    // 结果若停在缓冲区，拷回原数组
+    if (src != bboxes) {
+        copy(src, src + n, bboxes);
+    }
+}
+
+// 自底向上归并排序 - vector 封装：scratch 由调用方提供时可在多次排序间复用，容量足够则不再分配内存
+void mergeSortBottomUp(vector<BBox>& bboxes, vector<BBox>& scratch) {
+    if (scratch.size() < bboxes.size()) scratch.resize(bboxes.size());
+    bottomUpSortRange(bboxes.data(), scratch.data(), bboxes.size());
+}
+
+// 并行归并排序 - 工作窃取线程池分叉两半，顶层用归并路径并行归并；不超过 grain 的子段顺序排序
+void parallelMergeSort(vector<BBox>& bboxes, WorkStealingPool& pool, size_t grain = 1 << 14) {
+    vector<BBox> scratch(bboxes.size());
+    parallelMergeSortRange(bboxes.data(), scratch.data(), bboxes.size(),
+                           [](const BBox& a, const BBox& b) { return a.score > b.score; }, // 降序
+                           [](BBox* a, BBox* tmp, size_t n) { bottomUpSortRange(a, tmp, int(n)); },
+                           pool, grain);
 }
 
 // ====================== NMS算法实现 ======================
@@ -171,47 +218,30 @@ vector<BBox> nms(vector<BBox> bboxes, float iouThreshold = 0.5) {
 }
 
 // 排序类型枚举
-enum SortType { QUICK, BUBBLE, INSERTION, MERGE };
+enum SortType { QUICK, BUBBLE, INSERTION, MERGE, MERGE_BU };
 
-// 带排序的NMS整体耗时统计
-double nmsWithSortTime(vector<BBox> bboxes, SortType sortType) {
-    TIME_START
+// 排序+NMS 整体流程，计时交给基准框架；scratch 供自底向上归并复用，返回保留的框数
+size_t sortThenNms(vector<BBox>& bboxes, SortType sortType, vector<BBox>& scratch) {
     // 第一步：按置信度降序排序
     switch (sortType) {
         case QUICK:
             quickSort(bboxes, 0, bboxes.size() - 1);
             break;
-        case BUBBLE: {
-            int n = bboxes.size();
-            for (int i = 0; i < n - 1; i++) {
-                for (int j = 0; j < n - i - 1; j++) {
-                    if (bboxes[j].score < bboxes[j + 1].score) {
-                        swap(bboxes[j], bboxes[j + 1]);
-                    }
-                }
-            }
+        case BUBBLE:
+            bubbleSort(bboxes);
             break;
-        }
-        case INSERTION: {
-            int n = bboxes.size();
-            for (int i = 1; i < n; i++) {
-                BBox key = bboxes[i];
-                int j = i - 1;
-                while (j >= 0 && bboxes[j].score < key.score) {
-                    bboxes[j + 1] = bboxes[j];
-                    j--;
-                }
-                bboxes[j + 1] = key;
-            }
+        case INSERTION:
+            insertionSort(bboxes);
             break;
-        }
         case MERGE:
             mergeSort(bboxes, 0, bboxes.size() - 1);
             break;
+        case MERGE_BU:
+            mergeSortBottomUp(bboxes, scratch);
+            break;
     }
     // 第二步：执行NMS
-    nms(bboxes);
-    TIME_END
+    return nms(bboxes).size();
 }
 
 // ====================== 测试数据生成 ======================
@@ -259,61 +289,142 @@ vector<BBox> generateClusteredBBoxes(int num) {
     return bboxes;
 }
 
+static bool sameBBoxSequence(const vector<BBox>& a, const vector<BBox>& b) {
+    return a.size() == b.size() && equal(a.begin(), a.end(), b.begin(), [](const BBox& x, const BBox& y) {
+        return x.x1 == y.x1 && x.y1 == y.y1 && x.x2 == y.x2 && x.y2 == y.y2 && x.score == y.score;
+    });
+}
+
+// 并行归并排序与 stable_sort 对拍：规模含奇数和不足一个插入排序段的情况，粒度小到 1，线程数 1~3；
+// 置信度取 1/8 的整数倍，大量框置信度相同，逐框比较同时检查稳定性。返回不一致的组数
+size_t checkParallelMergeSort() {
+    const int sizes[] = {0, 1, 2, 3, 31, 33, 1000, 4097, 65537};
+    const size_t grains[] = {1, 3, 64, 1 << 14};
+    size_t mismatches = 0;
+    for (unsigned t = 1; t <= 3; ++t) {
+        WorkStealingPool pool(t);
+        for (int n : sizes) {
+            vector<BBox> input = generateRandomBBoxes(n);
+            for (auto& b : input) b.score = floor(b.score * 8) / 8;
+            vector<BBox> expected = input;
+            stable_sort(expected.begin(), expected.end(), [](const BBox& a, const BBox& b) { return a.score > b.score; });
+            for (size_t grain : grains) {
+                vector<BBox> got = input;
+                parallelMergeSort(got, pool, grain);
+                mismatches += !sameBBoxSequence(got, expected);
+            }
+        }
+    }
+    return mismatches;
+}
+
 // ====================== 主函数（性能测试） ======================
-int main() {
+int main(int argc, char** argv) {
+    // 命令行：--csv=路径 / --json=路径 导出结果，--cycles 用周期计数器计时，--samples=N 设置采样次数，
+    // --sort-n=N 设置并行归并排序测试的规模（默认 2^20，目标规模可给 10000000）
+    BenchOutput benchOutput = parseBenchArgs(argc, argv);
+    BenchConfig benchConfig = benchConfigFor(benchOutput);
+    BenchReport benchReport;
+    int sortScalingN = 1 << 20;
+    for (int i = 1; i < argc; ++i) {
+        if (strncmp(argv[i], "--sort-n=", 9) == 0) sortScalingN = max(1, atoi(argv[i] + 9));
+    }
+
     // 测试数据规模：100/1000/5000/10000
     vector<int> testScales = {100, 1000, 5000, 10000};
     // 排序算法名称（与枚举对应）
-    vector<string> sortNames = {"快速排序", "冒泡排序", "插入排序", "归并排序"};
+    vector<string> sortNames = {"快速排序", "冒泡排序", "插入排序", "归并排序", "自底向上归并"};
     // 数据分布名称
     vector<string> distNames = {"随机分布", "聚集分布"};
     // 数据生成函数
     vector<function<vector<BBox>(int)>> genFuncs = {generateRandomBBoxes, generateClusteredBBoxes};
 
     // ========== 测试1：单独排序算法性能 ==========
+    // 每种空间分布下按置信度生成五种输入顺序；O(n^2) 算法限制最大规模
     cout << "========================================" << endl;
-    cout << "单独排序算法性能测试（单位：毫秒）" << endl;
+    cout << "单独排序算法性能测试" << endl;
     cout << "========================================" << endl;
+    vector<BBox> sortScratch;  // 自底向上归并的缓冲区在 makeSorted 中按规模分配，不计入计时
+    vector<SortCase<BBox> > sortCases = {
+        {"quick", [](vector<BBox>& b) { quickSort(b, 0, b.size() - 1); }, 10000},
+        {"bubble", bubbleSort, 1000},
+        {"insertion", insertionSort, 10000},
+        {"merge", [](vector<BBox>& b) { mergeSort(b, 0, b.size() - 1); }, size_t(-1)},
+        {"merge-bottomup", [&sortScratch](vector<BBox>& b) { mergeSortBottomUp(b, sortScratch); }, size_t(-1)},
+    };
     for (int distIdx = 0; distIdx < 2; distIdx++) {
         cout << "\n【" << distNames[distIdx] << "】" << endl;
-        cout << "数据规模\t" << sortNames[0] << "\t" << sortNames[1] << "\t" 
-             << sortNames[2] << "\t" << sortNames[3] << endl;
-        cout << "----------------------------------------" << endl;
-        for (int scale : testScales) {
-            vector<BBox> bboxes = genFuncs[distIdx](scale);
-            double t_quick = quickSortWithTime(bboxes);
-            double t_bubble = bubbleSortWithTime(bboxes);
-            double t_insert = insertionSortWithTime(bboxes);
-            double t_merge = mergeSortWithTime(bboxes);
-            
-            // 格式化输出（保留3位小数）
-            printf("%d\t\t%.3f\t\t%.3f\t\t%.3f\t\t%.3f\n",
-                   scale, t_quick, t_bubble, t_insert, t_merge);
-        }
+        size_t first = benchReport.results().size();
+        auto makeSorted = [&](size_t n) {
+            sortScratch.resize(n);
+            vector<BBox> bboxes = genFuncs[distIdx](n);
+            stable_sort(bboxes.begin(), bboxes.end(), [](const BBox& a, const BBox& b) { return a.score > b.score; });
+            return bboxes;
+        };
+        benchmarkSorts(benchReport, benchConfig, geometricSizes(100, 100000, 10), makeSorted, sortCases,
+                       allDistributions(), distIdx == 0 ? "random-boxes" : "clustered-boxes");
+        benchReport.printTable(cout, first);
     }
 
     // ========== 测试2：排序+NMS整体性能 ==========
     cout << "\n========================================" << endl;
-    cout << "排序+NMS 整体性能测试（单位：毫秒）" << endl;
+    cout << "排序+NMS 整体性能测试（中位数，单位：" << (benchUsesCycles(benchConfig) ? "周期" : "毫秒") << "）" << endl;
     cout << "========================================" << endl;
+    // 每格为中位数，各次采样都从同一份未排序输入开始，结果同时写入报告
+    vector<string> nmsCaseNames = {"quick+nms", "bubble+nms", "insertion+nms", "merge+nms", "merge-bu+nms"};
     for (int distIdx = 0; distIdx < 2; distIdx++) {
         cout << "\n【" << distNames[distIdx] << "】" << endl;
         cout << "数据规模\t" << sortNames[0] << "+NMS\t" << sortNames[1] << "+NMS\t" 
-             << sortNames[2] << "+NMS\t" << sortNames[3] << "+NMS" << endl;
+             << sortNames[2] << "+NMS\t" << sortNames[3] << "+NMS\t" << sortNames[4] << "+NMS" << endl;
         cout << "----------------------------------------" << endl;
         for (int scale : testScales) {
-            vector<BBox> bboxes = genFuncs[distIdx](scale);
-            double t_quick_nms = nmsWithSortTime(bboxes, QUICK);
-            double t_bubble_nms = nmsWithSortTime(bboxes, BUBBLE);
-            double t_insert_nms = nmsWithSortTime(bboxes, INSERTION);
-            double t_merge_nms = nmsWithSortTime(bboxes, MERGE);
-            
+            vector<BBox> bboxes = genFuncs[distIdx](scale), work, scratch(scale);
+            double medians[5];
+            for (int type = QUICK; type <= MERGE_BU; type++) {
+                size_t kept = 0;
+                BenchResult r = runBenchmark(nmsCaseNames[type], "random", scale, benchConfig, [&] { work = bboxes; },
+                                             [&] { kept = sortThenNms(work, SortType(type), scratch); });
+                doNotOptimize(kept);
+                r.dataset = distIdx == 0 ? "random-boxes" : "clustered-boxes";
+                benchReport.add(r);
+                medians[type] = r.median;
+            }
+
             // 格式化输出（保留3位小数）
-            printf("%d\t\t%.3f\t\t%.3f\t\t%.3f\t\t%.3f\n",
-                   scale, t_quick_nms, t_bubble_nms, t_insert_nms, t_merge_nms);
+            printf("%d\t\t%.3f\t\t%.3f\t\t%.3f\t\t%.3f\t\t%.3f\n",
+                   scale, medians[0], medians[1], medians[2], medians[3], medians[4]);
+        }
+    }
+
+    // ========== 测试3：并行归并排序加速比 ==========
+    cout << "\n========================================" << endl;
+    cout << "并行归并排序加速比测试" << endl;
+    cout << "========================================" << endl;
+    {
+        printf("与 stable_sort 对拍（各种规模 / 粒度 / 线程数）：%zu 组不一致\n", checkParallelMergeSort());
+        const int scale = sortScalingN;
+        vector<BBox> bboxes = generateRandomBBoxes(scale);
+        vector<BBox> expected = bboxes;
+        stable_sort(expected.begin(), expected.end(), [](const BBox& a, const BBox& b) { return a.score > b.score; });
+        vector<BBox> data, scratch;
+        auto reset = [&] { data = bboxes; };
+        BenchResult base = runBenchmark("merge-bottomup", "random", scale, benchConfig, reset,
+                                        [&] { mergeSortBottomUp(data, scratch); });
+        benchReport.add(base);
+        printf("数据规模 %d，单线程自底向上归并基准：%.3f %s\n", scale, base.median, base.unit.c_str());
+        cout << "线程数\t\t中位数\t\t加速比" << endl;
+        cout << "----------------------------------------" << endl;
+        for (unsigned t : scalingThreadCounts()) {
+            WorkStealingPool pool(t);
+            BenchResult r = runBenchmark("parallel-t" + to_string(t), "random", scale, benchConfig, reset,
+                                         [&] { parallelMergeSort(data, pool); });
+            benchReport.add(r);
+            printf("%u\t\t%.3f\t\t%.2f%s\n", t, r.median, base.median / r.median,
+                   sameBBoxSequence(data, expected) ? "" : "\t结果不一致!");
         }
     }
 
+    writeBenchOutput(benchReport, benchOutput);
     cout << "\n测试完成！" << endl;
     return 0;
 }